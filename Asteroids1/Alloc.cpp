@@ -0,0 +1,113 @@
+//
+//  Alloc.cpp
+//  Asteroids1
+//
+
+#include "Alloc.h"
+
+#include <stdlib.h>
+#include <atomic>
+#include <new>
+
+const char *ALLOC_PHASE_NAMES[N_ALLOC_PHASES] = { "other", "input", "update", "render" };
+
+static std::atomic<int> gAllocPhase(AllocPhase_Other);
+static std::atomic<Uint64> gAllocCount[N_ALLOC_PHASES];
+static std::atomic<Uint64> gAllocBytes[N_ALLOC_PHASES];
+
+static void *trackedAllocate(size_t size)
+{
+    int phase = gAllocPhase.load(std::memory_order_relaxed);
+    gAllocCount[phase].fetch_add(1, std::memory_order_relaxed);
+    gAllocBytes[phase].fetch_add(size, std::memory_order_relaxed);
+
+    return malloc((size == 0) ? 1 : size);
+}
+
+void *operator new(size_t size)
+{
+    void *p = trackedAllocate(size);
+
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    return p;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    return trackedAllocate(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+    return trackedAllocate(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    free(p);
+}
+
+// C++14 callers may pass the size back; it isn't needed to free.
+void operator delete(void *p, size_t) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+    operator delete[](p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept
+{
+    free(p);
+}
+
+void allocSetPhase(AllocPhase phase)
+{
+    gAllocPhase.store(phase, std::memory_order_relaxed);
+}
+
+void allocGetCounts(AllocCounts counts[N_ALLOC_PHASES])
+{
+    for (int phase = 0; phase < N_ALLOC_PHASES; phase++)
+    {
+        counts[phase].count = gAllocCount[phase].load(std::memory_order_relaxed);
+        counts[phase].bytes = gAllocBytes[phase].load(std::memory_order_relaxed);
+    }
+}
+
+Uint64 allocDifference(const AllocCounts before[N_ALLOC_PHASES],
+                       const AllocCounts after[N_ALLOC_PHASES],
+                       AllocCounts counts[N_ALLOC_PHASES])
+{
+    Uint64 total = 0;
+
+    for (int phase = 0; phase < N_ALLOC_PHASES; phase++)
+    {
+        counts[phase].count = after[phase].count - before[phase].count;
+        counts[phase].bytes = after[phase].bytes - before[phase].bytes;
+        total += counts[phase].count;
+    }
+
+    return total;
+}
@@ -0,0 +1,40 @@
+//
+//  Alloc.h
+//  Asteroids1
+//
+//  Counts every operator new made by the process, attributed to whichever
+//  phase of the frame is current, so per-tick and per-frame heap traffic
+//  can be measured by diffing two snapshots.
+//
+
+#ifndef Alloc_h
+#define Alloc_h
+
+#include <SDL2/SDL.h>
+
+typedef enum
+{
+    AllocPhase_Other,
+    AllocPhase_Input,
+    AllocPhase_Update,
+    AllocPhase_Render,
+    N_ALLOC_PHASES
+} AllocPhase;
+
+typedef struct
+{
+    Uint64 count;
+    Uint64 bytes;
+} AllocCounts;
+
+extern const char *ALLOC_PHASE_NAMES[N_ALLOC_PHASES];
+
+void allocSetPhase(AllocPhase phase);
+// Running totals per phase since startup.
+void allocGetCounts(AllocCounts counts[N_ALLOC_PHASES]);
+// counts[phase] = after[phase] - before[phase]; returns the total count.
+Uint64 allocDifference(const AllocCounts before[N_ALLOC_PHASES],
+                       const AllocCounts after[N_ALLOC_PHASES],
+                       AllocCounts counts[N_ALLOC_PHASES]);
+
+#endif /* Alloc_h */
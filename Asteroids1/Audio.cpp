@@ -0,0 +1,425 @@
+//
+//  Audio.cpp
+//  Asteroids1
+//
+
+#include "Audio.h"
+#include "Log.h"
+
+#include <math.h>
+#include <atomic>
+#include <vector>
+
+static const int AUDIO_FREQUENCY = 44100;
+static const int AUDIO_BUFFER_SAMPLES = 512; // ~11.6 ms at 44.1 kHz.
+static const int MAX_VOICES = 16;
+static const int COMMAND_QUEUE_SIZE = 64;    // Must be a power of two.
+static const int LOOP_RELEASE_SAMPLES = 256; // Fade so stopping doesn't click.
+
+static const float SOUND_GAINS[N_SOUNDS] = { 0.25f, 0.5f, 0.35f, 0.2f };
+
+typedef enum
+{
+    AudioCommand_Play,
+    AudioCommand_StartLoop,
+    AudioCommand_StopLoop
+} AudioCommandType;
+
+typedef struct
+{
+    AudioCommandType type;
+    Sound sound;
+} AudioCommand;
+
+typedef struct
+{
+    bool active;
+    bool looping;
+    Sound sound;
+    int position;
+    int release; // Samples left in the fade out, 0 when not releasing.
+    float gain;
+} Voice;
+
+static SDL_AudioDeviceID gDevice = 0;
+static std::vector<float> gSoundPCM[N_SOUNDS];
+
+// Owned by the audio callback once the device is running.
+static Voice gVoices[MAX_VOICES];
+static float gMixBuffer[AUDIO_BUFFER_SAMPLES];
+static Uint64 gLastCallbackStart = 0;
+
+// Single producer (simulation), single consumer (callback).
+static AudioCommand gCommands[COMMAND_QUEUE_SIZE];
+static std::atomic<unsigned int> gCommandHead(0);
+static std::atomic<unsigned int> gCommandTail(0);
+
+// Simulation-side loop state, so audioSetLoop only sends changes.
+static bool gLoopRequested[N_SOUNDS];
+
+static std::atomic<Uint32> gCallbacks(0);
+static std::atomic<Uint32> gUnderruns(0);
+static std::atomic<Uint32> gDroppedCommands(0);
+static std::atomic<Uint32> gStolenVoices(0);
+static std::atomic<int> gActiveVoices(0);
+static std::atomic<Uint64> gLastCallbackTicks(0);
+static std::atomic<Uint64> gMaxCallbackTicks(0);
+static std::atomic<Uint64> gTotalCallbackTicks(0);
+
+// Small LCG of its own, so synthesis never draws from the simulation's
+// seeded random stream.
+static float noise(Uint32 &state)
+{
+    state = state * 1664525u + 1013904223u;
+    return (state >> 8) / 8388608.0f - 1.0f;
+}
+
+static void synthesizeSounds()
+{
+    Uint32 seed = 1;
+
+    // Fire: short square wave sweeping down from 1200 Hz to 400 Hz.
+    {
+        std::vector<float> &pcm = gSoundPCM[Sound_Fire];
+        pcm.resize(AUDIO_FREQUENCY * 0.08f);
+        float phase = 0.0f;
+
+        for (int i = 0; i < (int)pcm.size(); i++)
+        {
+            float t = (float)i / pcm.size();
+            phase += (1200.0f - 800.0f * t) / AUDIO_FREQUENCY;
+            pcm[i] = ((fmodf(phase, 1.0f) < 0.5f) ? 1.0f : -1.0f) * (1.0f - t);
+        }
+    }
+
+    // Explosion: low-passed noise with an exponential decay.
+    {
+        std::vector<float> &pcm = gSoundPCM[Sound_Explosion];
+        pcm.resize(AUDIO_FREQUENCY * 0.6f);
+        float filtered = 0.0f;
+
+        for (int i = 0; i < (int)pcm.size(); i++)
+        {
+            float t = (float)i / AUDIO_FREQUENCY;
+            filtered += 0.08f * (noise(seed) - filtered);
+            pcm[i] = 4.0f * filtered * expf(-6.0f * t);
+        }
+    }
+
+    // Split: a brighter, shorter crack over a falling 140 Hz thump.
+    {
+        std::vector<float> &pcm = gSoundPCM[Sound_Split];
+        pcm.resize(AUDIO_FREQUENCY * 0.25f);
+        float filtered = 0.0f;
+
+        for (int i = 0; i < (int)pcm.size(); i++)
+        {
+            float t = (float)i / AUDIO_FREQUENCY;
+            filtered += 0.3f * (noise(seed) - filtered);
+            float thump = sinf(2 * M_PI * 140.0f * t * (1.0f - t));
+            pcm[i] = (0.6f * filtered + 0.6f * thump) * expf(-12.0f * t);
+        }
+    }
+
+    // Thrust: steady rumble meant to loop.
+    {
+        std::vector<float> &pcm = gSoundPCM[Sound_Thrust];
+        pcm.resize(AUDIO_FREQUENCY * 0.5f);
+        float filtered = 0.0f;
+
+        for (int i = 0; i < (int)pcm.size(); i++)
+        {
+            filtered += 0.03f * (noise(seed) - filtered);
+            pcm[i] = 6.0f * filtered;
+        }
+    }
+}
+
+// False, and counted as dropped, if the queue is full.
+static bool pushCommand(AudioCommandType type, Sound sound)
+{
+    unsigned int head = gCommandHead.load(std::memory_order_relaxed);
+
+    if (head - gCommandTail.load(std::memory_order_acquire) >= COMMAND_QUEUE_SIZE)
+    {
+        gDroppedCommands.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    gCommands[head & (COMMAND_QUEUE_SIZE - 1)] = { type, sound };
+    gCommandHead.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+// Picks a free voice, or steals the one-shot closest to finishing.
+static Voice *allocateVoice()
+{
+    Voice *best = nullptr;
+    int bestRemaining = 0;
+
+    for (int i = 0; i < MAX_VOICES; i++)
+    {
+        Voice &voice = gVoices[i];
+
+        if (!voice.active)
+        {
+            return &voice;
+        }
+
+        if (voice.looping)
+        {
+            continue;
+        }
+
+        int remaining = (int)gSoundPCM[voice.sound].size() - voice.position;
+
+        if (best == nullptr || remaining < bestRemaining)
+        {
+            best = &voice;
+            bestRemaining = remaining;
+        }
+    }
+
+    if (best != nullptr)
+    {
+        gStolenVoices.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    return best;
+}
+
+static void processCommands()
+{
+    unsigned int tail = gCommandTail.load(std::memory_order_relaxed);
+    unsigned int head = gCommandHead.load(std::memory_order_acquire);
+
+    for (; tail != head; tail++)
+    {
+        AudioCommand command = gCommands[tail & (COMMAND_QUEUE_SIZE - 1)];
+
+        if (command.type == AudioCommand_StopLoop)
+        {
+            for (int i = 0; i < MAX_VOICES; i++)
+            {
+                Voice &voice = gVoices[i];
+
+                if (voice.active && voice.looping && voice.sound == command.sound &&
+                    voice.release == 0)
+                {
+                    voice.release = LOOP_RELEASE_SAMPLES;
+                }
+            }
+
+            continue;
+        }
+
+        Voice *voice = allocateVoice();
+
+        if (voice != nullptr)
+        {
+            voice->active = true;
+            voice->looping = (command.type == AudioCommand_StartLoop);
+            voice->sound = command.sound;
+            voice->position = 0;
+            voice->release = 0;
+            voice->gain = SOUND_GAINS[command.sound];
+        }
+    }
+
+    gCommandTail.store(tail, std::memory_order_release);
+}
+
+static void mixVoice(Voice &voice, float *mix, int nSamples)
+{
+    const std::vector<float> &pcm = gSoundPCM[voice.sound];
+    int length = (int)pcm.size();
+
+    for (int i = 0; i < nSamples; i++)
+    {
+        if (voice.position >= length)
+        {
+            if (!voice.looping)
+            {
+                voice.active = false;
+                return;
+            }
+
+            voice.position = 0;
+        }
+
+        float gain = voice.gain;
+
+        if (voice.release > 0)
+        {
+            gain *= (float)voice.release / LOOP_RELEASE_SAMPLES;
+
+            if (--voice.release == 0)
+            {
+                voice.active = false;
+                return;
+            }
+        }
+
+        mix[i] += pcm[voice.position++] * gain;
+    }
+}
+
+static void audioCallback(void *, Uint8 *stream, int len)
+{
+    Uint64 start = SDL_GetPerformanceCounter();
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+    Uint64 period = frequency * AUDIO_BUFFER_SAMPLES / AUDIO_FREQUENCY;
+
+    // SDL calls back roughly once per buffer; a much longer gap means the
+    // device ran dry before we were asked for more.
+    if (gLastCallbackStart != 0 && start - gLastCallbackStart > 2 * period)
+    {
+        gUnderruns.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    gLastCallbackStart = start;
+
+    processCommands();
+
+    Sint16 *out = (Sint16 *)stream;
+    int nSamples = len / (int)sizeof(Sint16);
+
+    while (nSamples > 0)
+    {
+        int chunk = (nSamples < AUDIO_BUFFER_SAMPLES) ? nSamples : AUDIO_BUFFER_SAMPLES;
+
+        for (int i = 0; i < chunk; i++)
+        {
+            gMixBuffer[i] = 0.0f;
+        }
+
+        for (int voiceIndex = 0; voiceIndex < MAX_VOICES; voiceIndex++)
+        {
+            if (gVoices[voiceIndex].active)
+            {
+                mixVoice(gVoices[voiceIndex], gMixBuffer, chunk);
+            }
+        }
+
+        for (int i = 0; i < chunk; i++)
+        {
+            float sample = fmaxf(-1.0f, fminf(1.0f, gMixBuffer[i]));
+            out[i] = (Sint16)(sample * 32767.0f);
+        }
+
+        out += chunk;
+        nSamples -= chunk;
+    }
+
+    int activeVoices = 0;
+
+    for (int voiceIndex = 0; voiceIndex < MAX_VOICES; voiceIndex++)
+    {
+        activeVoices += gVoices[voiceIndex].active;
+    }
+
+    Uint64 elapsed = SDL_GetPerformanceCounter() - start;
+
+    if (elapsed > period)
+    {
+        gUnderruns.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    gActiveVoices.store(activeVoices, std::memory_order_relaxed);
+    gLastCallbackTicks.store(elapsed, std::memory_order_relaxed);
+    gTotalCallbackTicks.fetch_add(elapsed, std::memory_order_relaxed);
+
+    if (elapsed > gMaxCallbackTicks.load(std::memory_order_relaxed))
+    {
+        gMaxCallbackTicks.store(elapsed, std::memory_order_relaxed);
+    }
+
+    gCallbacks.fetch_add(1, std::memory_order_release);
+}
+
+bool audioInit()
+{
+    synthesizeSounds();
+
+    SDL_AudioSpec want = {};
+    want.freq = AUDIO_FREQUENCY;
+    want.format = AUDIO_S16SYS;
+    want.channels = 1;
+    want.samples = AUDIO_BUFFER_SAMPLES;
+    want.callback = audioCallback;
+
+    // No allowed changes: SDL converts to the device format for us, so the
+    // callback always sees mono S16 at AUDIO_FREQUENCY.
+    gDevice = SDL_OpenAudioDevice(nullptr, 0, &want, nullptr, 0);
+
+    if (gDevice == 0)
+    {
+        logMessage(LogLevel_Warning, "Unable to open audio device: %s", SDL_GetError());
+        return false;
+    }
+
+    logMessage(LogLevel_Info, "Audio: %s driver, %d Hz, %d sample buffer",
+               SDL_GetCurrentAudioDriver(), AUDIO_FREQUENCY, AUDIO_BUFFER_SAMPLES);
+
+    SDL_PauseAudioDevice(gDevice, 0);
+
+    return true;
+}
+
+void audioQuit()
+{
+    if (gDevice == 0)
+    {
+        return;
+    }
+
+    SDL_CloseAudioDevice(gDevice);
+    gDevice = 0;
+
+    AudioStats stats;
+    audioGetStats(stats);
+    logMessage(LogLevel_Info,
+               "Audio: %u callbacks, %.1f us avg, %.1f us max, %u underruns, %u dropped commands",
+               stats.callbacks, stats.averageCallbackUs, stats.maxCallbackUs,
+               stats.underruns, stats.droppedCommands);
+}
+
+void audioPlay(Sound sound)
+{
+    if (gDevice != 0)
+    {
+        pushCommand(AudioCommand_Play, sound);
+    }
+}
+
+void audioSetLoop(Sound sound, bool playing)
+{
+    if (gDevice == 0 || gLoopRequested[sound] == playing)
+    {
+        return;
+    }
+
+    // Only a command that made it into the queue changes the state, so a
+    // dropped one is sent again on the next call.
+    if (pushCommand(playing ? AudioCommand_StartLoop : AudioCommand_StopLoop, sound))
+    {
+        gLoopRequested[sound] = playing;
+    }
+}
+
+void audioGetStats(AudioStats &stats)
+{
+    double usPerTick = 1e6 / SDL_GetPerformanceFrequency();
+    Uint32 callbacks = gCallbacks.load(std::memory_order_acquire);
+
+    stats.callbacks = callbacks;
+    stats.underruns = gUnderruns.load(std::memory_order_relaxed);
+    stats.droppedCommands = gDroppedCommands.load(std::memory_order_relaxed);
+    stats.stolenVoices = gStolenVoices.load(std::memory_order_relaxed);
+    stats.activeVoices = gActiveVoices.load(std::memory_order_relaxed);
+    stats.lastCallbackUs = gLastCallbackTicks.load(std::memory_order_relaxed) * usPerTick;
+    stats.maxCallbackUs = gMaxCallbackTicks.load(std::memory_order_relaxed) * usPerTick;
+    stats.averageCallbackUs = (callbacks == 0) ? 0.0 :
+        gTotalCallbackTicks.load(std::memory_order_relaxed) * usPerTick / callbacks;
+    stats.bufferMs = 1000.0 * AUDIO_BUFFER_SAMPLES / AUDIO_FREQUENCY;
+}
@@ -0,0 +1,54 @@
+//
+//  Audio.h
+//  Asteroids1
+//
+//  Callback-driven mixer.  All PCM is synthesized once in audioInit(); the
+//  simulation thread only pushes small commands onto a lock-free queue, and
+//  the SDL audio callback mixes a fixed pool of voices without allocating
+//  or taking locks.
+//
+
+#ifndef Audio_h
+#define Audio_h
+
+#include <SDL2/SDL.h>
+
+typedef enum
+{
+    Sound_Fire,
+    Sound_Explosion,
+    Sound_Split,
+    Sound_Thrust,
+    N_SOUNDS
+} Sound;
+
+typedef struct
+{
+    Uint32 callbacks;
+    Uint32 underruns;        // Callbacks that arrived or finished too late.
+    Uint32 droppedCommands;  // Commands lost because the queue was full.
+    Uint32 stolenVoices;     // Voices cut short because the pool was full.
+    int activeVoices;
+    double lastCallbackUs;
+    double maxCallbackUs;
+    double averageCallbackUs;
+    double bufferMs;         // Time one callback's worth of samples covers.
+} AudioStats;
+
+// Opens the default device through whatever driver SDL_AUDIODRIVER picks
+// (e.g. "dummy" or "disk" for headless runs).  The audio subsystem must
+// already be initialized.  Returns false, leaving the game silent, if no
+// device could be opened.
+bool audioInit();
+void audioQuit();
+
+// Simulation-thread API.
+void audioPlay(Sound sound);
+// Starts or stops a looping voice for sound.  Only state changes reach the
+// audio thread, so this can be called every tick; a change dropped by a
+// full queue is retried on the next call.
+void audioSetLoop(Sound sound, bool playing);
+
+void audioGetStats(AudioStats &stats);
+
+#endif /* Audio_h */
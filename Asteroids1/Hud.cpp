@@ -0,0 +1,321 @@
+//
+//  Hud.cpp
+//  Asteroids1
+//
+
+#include "Hud.h"
+#include "FontAtlas.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+static const int HUD_X = 10;
+static const int HUD_Y = 10;
+static const int HUD_WIDTH = 480; // Graph width; the panel grows to fit its text.
+static const int HUD_TEXT_SCALE = 2;
+static const int HUD_LINE_HEIGHT = (FONTATLAS_GLYPH_HEIGHT + 2) * HUD_TEXT_SCALE;
+static const int HUD_MAX_GLYPHS = 1024;
+static const int HUD_HISTORY = 120;
+static const int HUD_GRAPH_HEIGHT = 60;
+static const float HUD_GRAPH_MS = 33.3f;     // Full graph height.
+static const float HUD_BUDGET_MS = 1000.0f / 60;
+static const double HUD_SMOOTHING = 0.05;    // Weight of the newest frame.
+
+static const char *HUD_PHASE_NAMES[N_HUD_PHASES] = {
+    "input", "proj", "ast", "ship", "coll", "render", "hud", "present"
+};
+
+static SDL_Renderer *gHudRenderer = nullptr;
+static SDL_Texture *gHudFont = nullptr;
+static int gHudAtlasColumns = 1;
+static float gHudAtlasWidth = 1.0f;
+static float gHudAtlasHeight = 1.0f;
+static bool gHudVisible = false;
+
+static Uint64 gPhaseStart[N_HUD_PHASES];
+static Uint64 gPhaseFrameTicks[N_HUD_PHASES];
+static double gPhaseMs[N_HUD_PHASES];
+
+static float gFrameHistory[HUD_HISTORY];
+static float gTickHistory[HUD_HISTORY];
+static int gFrameHistoryIndex = 0;
+static int gTickHistoryIndex = 0;
+
+static Uint64 gSecondStart = 0;
+static int gFramesThisSecond = 0;
+static int gTicksThisSecond = 0;
+static int gFramesPerSecond = 0;
+static int gTicksPerSecond = 0;
+static double gFrameMs = 0.0;
+static double gTickMs = 0.0;
+static HudFrameStats gStats;
+static int gHudDrawCalls = 0;
+
+static SDL_Vertex gGlyphVertices[HUD_MAX_GLYPHS * 4];
+static int gGlyphIndices[HUD_MAX_GLYPHS * 6];
+static int gGlyphCount = 0;
+static int gTextRight = 0; // Right edge of the widest hudText line so far.
+static SDL_Rect gBars[HUD_HISTORY];
+
+void hudInit(SDL_Renderer *renderer, SDL_Texture *fontAtlas, int atlasColumns)
+{
+    int width = 1, height = 1;
+    SDL_QueryTexture(fontAtlas, nullptr, nullptr, &width, &height);
+
+    gHudRenderer = renderer;
+    gHudFont = fontAtlas;
+    gHudAtlasColumns = atlasColumns;
+    gHudAtlasWidth = (float)width;
+    gHudAtlasHeight = (float)height;
+    gSecondStart = SDL_GetPerformanceCounter();
+    gStats.timeScale = 1.0f;
+
+    // The quad topology never changes, only the vertices do.
+    for (int glyph = 0; glyph < HUD_MAX_GLYPHS; glyph++)
+    {
+        int *indices = &gGlyphIndices[glyph * 6];
+        int base = glyph * 4;
+
+        indices[0] = base;
+        indices[1] = base + 1;
+        indices[2] = base + 2;
+        indices[3] = base;
+        indices[4] = base + 2;
+        indices[5] = base + 3;
+    }
+}
+
+void hudToggle()
+{
+    gHudVisible = !gHudVisible;
+}
+
+void hudPhaseBegin(HudPhase phase)
+{
+    gPhaseStart[phase] = SDL_GetPerformanceCounter();
+}
+
+void hudPhaseEnd(HudPhase phase)
+{
+    gPhaseFrameTicks[phase] += SDL_GetPerformanceCounter() - gPhaseStart[phase];
+}
+
+void hudTick(double tickMs)
+{
+    gTickHistory[gTickHistoryIndex] = (float)tickMs;
+    gTickHistoryIndex = (gTickHistoryIndex + 1) % HUD_HISTORY;
+    gTickMs += HUD_SMOOTHING * (tickMs - gTickMs);
+    gTicksThisSecond++;
+}
+
+void hudFrame(double frameMs, const HudFrameStats &stats)
+{
+    double msPerTick = 1000.0 / SDL_GetPerformanceFrequency();
+
+    for (int phase = 0; phase < N_HUD_PHASES; phase++)
+    {
+        double ms = gPhaseFrameTicks[phase] * msPerTick;
+        gPhaseMs[phase] += HUD_SMOOTHING * (ms - gPhaseMs[phase]);
+        gPhaseFrameTicks[phase] = 0;
+    }
+
+    gFrameHistory[gFrameHistoryIndex] = (float)frameMs;
+    gFrameHistoryIndex = (gFrameHistoryIndex + 1) % HUD_HISTORY;
+    gFrameMs += HUD_SMOOTHING * (frameMs - gFrameMs);
+    gStats = stats;
+    gFramesThisSecond++;
+
+    Uint64 now = SDL_GetPerformanceCounter();
+
+    if (now - gSecondStart >= SDL_GetPerformanceFrequency())
+    {
+        gFramesPerSecond = gFramesThisSecond;
+        gTicksPerSecond = gTicksThisSecond;
+        gFramesThisSecond = 0;
+        gTicksThisSecond = 0;
+        gSecondStart = now;
+    }
+}
+
+// Appends one line of text to the glyph batch.
+static void hudText(int x, int y, const char *format, ...)
+{
+    char text[96];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+
+    int glyphWidth = FONTATLAS_GLYPH_WIDTH * HUD_TEXT_SCALE;
+    int glyphHeight = FONTATLAS_GLYPH_HEIGHT * HUD_TEXT_SCALE;
+    int glyphAdvance = (FONTATLAS_GLYPH_WIDTH + 1) * HUD_TEXT_SCALE;
+    SDL_Color color = { 120, 255, 120, 255 };
+    int right = x + (int)strlen(text) * glyphAdvance;
+
+    if (right > gTextRight)
+    {
+        gTextRight = right;
+    }
+
+    for (int charIndex = 0; text[charIndex] != '\0'; charIndex++)
+    {
+        int glyphIndex = (unsigned char)text[charIndex] - FONTATLAS_FIRST_CHAR;
+
+        if (glyphIndex <= 0 || glyphIndex >= FONTATLAS_N_GLYPHS ||
+            gGlyphCount == HUD_MAX_GLYPHS)
+        {
+            continue;
+        }
+
+        float u0 = (glyphIndex % gHudAtlasColumns) * FONTATLAS_GLYPH_WIDTH / gHudAtlasWidth;
+        float v0 = (glyphIndex / gHudAtlasColumns) * FONTATLAS_GLYPH_HEIGHT / gHudAtlasHeight;
+        float u1 = u0 + FONTATLAS_GLYPH_WIDTH / gHudAtlasWidth;
+        float v1 = v0 + FONTATLAS_GLYPH_HEIGHT / gHudAtlasHeight;
+        float x0 = (float)(x + charIndex * glyphAdvance);
+        float y0 = (float)y;
+
+        SDL_Vertex *quad = &gGlyphVertices[gGlyphCount * 4];
+        quad[0] = { { x0, y0 }, color, { u0, v0 } };
+        quad[1] = { { x0 + glyphWidth, y0 }, color, { u1, v0 } };
+        quad[2] = { { x0 + glyphWidth, y0 + glyphHeight }, color, { u1, v1 } };
+        quad[3] = { { x0, y0 + glyphHeight }, color, { u0, v1 } };
+        gGlyphCount++;
+    }
+}
+
+// One bar per history entry, oldest on the left, in a single fill call.
+static void hudGraph(const float *history, int newest, int y, Uint8 r, Uint8 g, Uint8 b)
+{
+    int barWidth = (HUD_WIDTH - 20) / HUD_HISTORY;
+
+    for (int i = 0; i < HUD_HISTORY; i++)
+    {
+        float ms = history[(newest + i) % HUD_HISTORY];
+        int height = (int)(ms / HUD_GRAPH_MS * HUD_GRAPH_HEIGHT);
+
+        if (height > HUD_GRAPH_HEIGHT)
+        {
+            height = HUD_GRAPH_HEIGHT;
+        }
+
+        gBars[i] = {
+            HUD_X + 10 + i * barWidth,
+            y + HUD_GRAPH_HEIGHT - height,
+            barWidth,
+            height
+        };
+    }
+
+    SDL_SetRenderDrawColor(gHudRenderer, r, g, b, 255);
+    SDL_RenderFillRects(gHudRenderer, gBars, HUD_HISTORY);
+
+    int budgetY = y + HUD_GRAPH_HEIGHT - (int)(HUD_BUDGET_MS / HUD_GRAPH_MS * HUD_GRAPH_HEIGHT);
+    SDL_SetRenderDrawColor(gHudRenderer, 255, 80, 80, 255);
+    SDL_RenderDrawLine(gHudRenderer, HUD_X + 10, budgetY, HUD_X + HUD_WIDTH - 10, budgetY);
+    gHudDrawCalls += 2;
+}
+
+// The full overlay: panel, stats text and both history graphs.
+static void hudPanel(int drawCalls, const char *speed)
+{
+    int x = HUD_X + 10;
+    int y = HUD_Y + 10;
+
+    gTextRight = 0;
+    hudText(x, y, "FPS %d  TPS %d  res %d%%  speed %s", gFramesPerSecond, gTicksPerSecond,
+            (int)(gStats.renderScale * 100 + 0.5f), speed);
+    y += HUD_LINE_HEIGHT;
+    hudText(x, y, "frame %.2f ms  tick %.3f ms", gFrameMs, gTickMs);
+    y += HUD_LINE_HEIGHT;
+    hudText(x, y, "update  %s %.3f %s %.3f %s %.3f",
+            HUD_PHASE_NAMES[HudPhase_Input], gPhaseMs[HudPhase_Input],
+            HUD_PHASE_NAMES[HudPhase_Projectiles], gPhaseMs[HudPhase_Projectiles],
+            HUD_PHASE_NAMES[HudPhase_Asteroids], gPhaseMs[HudPhase_Asteroids]);
+    y += HUD_LINE_HEIGHT;
+    hudText(x, y, "        %s %.3f %s %.3f",
+            HUD_PHASE_NAMES[HudPhase_Ship], gPhaseMs[HudPhase_Ship],
+            HUD_PHASE_NAMES[HudPhase_Collisions], gPhaseMs[HudPhase_Collisions]);
+    y += HUD_LINE_HEIGHT;
+    hudText(x, y, "render  %s %.3f %s %.3f %s %.3f",
+            HUD_PHASE_NAMES[HudPhase_Render], gPhaseMs[HudPhase_Render],
+            HUD_PHASE_NAMES[HudPhase_Hud], gPhaseMs[HudPhase_Hud],
+            HUD_PHASE_NAMES[HudPhase_Present], gPhaseMs[HudPhase_Present]);
+    y += HUD_LINE_HEIGHT;
+    hudText(x, y, "asteroids %d  projectiles %d  particles %d",
+            gStats.asteroids, gStats.projectiles, gStats.particles);
+    y += HUD_LINE_HEIGHT;
+    hudText(x, y, "transforms %d  avoided %d",
+            gStats.transforms, gStats.transformsAvoided);
+    y += HUD_LINE_HEIGHT;
+    hudText(x, y, "draw calls %d (+%d hud)  allocs %llu  input p95 %.1f ms",
+            gStats.drawCalls, drawCalls, (unsigned long long)gStats.allocations,
+            gStats.inputLatencyP95Us / 1000.0);
+    y += HUD_LINE_HEIGHT;
+
+    int frameGraphY = y + 4;
+    int tickGraphY = frameGraphY + HUD_GRAPH_HEIGHT + HUD_LINE_HEIGHT;
+
+    hudText(x, frameGraphY + HUD_GRAPH_HEIGHT + 2, "frame ms");
+    hudText(x, tickGraphY + HUD_GRAPH_HEIGHT + 2, "tick ms");
+
+    SDL_Rect panel = {
+        HUD_X,
+        HUD_Y,
+        std::max(HUD_WIDTH, gTextRight + 10 - HUD_X),
+        tickGraphY + HUD_GRAPH_HEIGHT + HUD_LINE_HEIGHT + 4 - HUD_Y
+    };
+
+    SDL_SetRenderDrawBlendMode(gHudRenderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(gHudRenderer, 0, 0, 0, 180);
+    SDL_RenderFillRect(gHudRenderer, &panel);
+    SDL_SetRenderDrawBlendMode(gHudRenderer, SDL_BLENDMODE_NONE);
+    gHudDrawCalls++;
+
+    hudGraph(gFrameHistory, gFrameHistoryIndex, frameGraphY, 80, 160, 255);
+    hudGraph(gTickHistory, gTickHistoryIndex, tickGraphY, 255, 200, 80);
+}
+
+void hudRender()
+{
+    bool timeScaled = (gStats.timeScale != 1.0f);
+
+    if (!gHudVisible && !timeScaled)
+    {
+        return;
+    }
+
+    hudPhaseBegin(HudPhase_Hud);
+
+    int drawCalls = gHudDrawCalls;
+    gHudDrawCalls = 0;
+    gGlyphCount = 0;
+
+    char speed[16];
+
+    if (gStats.timeScale >= 1.0f)
+    {
+        snprintf(speed, sizeof(speed), "%gx", gStats.timeScale);
+    }
+    else
+    {
+        snprintf(speed, sizeof(speed), "1/%gx", 1.0f / gStats.timeScale);
+    }
+
+    if (gHudVisible)
+    {
+        hudPanel(drawCalls, speed);
+    }
+    else
+    {
+        hudText(HUD_X + 10, HUD_Y + 10, "speed %s  TPS %d", speed, gTicksPerSecond);
+    }
+
+    SDL_SetTextureColorMod(gHudFont, 255, 255, 255);
+    SDL_RenderGeometry(gHudRenderer, gHudFont, gGlyphVertices, gGlyphCount * 4,
+                       gGlyphIndices, gGlyphCount * 6);
+    gHudDrawCalls++;
+
+    hudPhaseEnd(HudPhase_Hud);
+}
@@ -0,0 +1,59 @@
+//
+//  Hud.h
+//  Asteroids1
+//
+//  Toggleable performance overlay.  Timing is collected every frame
+//  whether or not the overlay is shown, and the overlay itself is drawn
+//  with a handful of batched calls (one geometry call for all of its text),
+//  so turning it on barely moves the numbers it reports.
+//
+
+#ifndef Hud_h
+#define Hud_h
+
+#include <SDL2/SDL.h>
+
+typedef enum
+{
+    HudPhase_Input,
+    HudPhase_Projectiles,
+    HudPhase_Asteroids,
+    HudPhase_Ship,
+    HudPhase_Collisions,
+    HudPhase_Render,
+    HudPhase_Hud,
+    HudPhase_Present,
+    N_HUD_PHASES
+} HudPhase;
+
+typedef struct
+{
+    int asteroids;
+    int projectiles;
+    int particles;
+    int drawCalls;
+    Uint64 allocations;
+    Uint32 inputLatencyP95Us;
+    float renderScale;
+    float timeScale; // Multiple of real time the simulation is asked to run at.
+    int transforms;        // Asteroid outlines moved to world space this frame,
+    int transformsAvoided; // and uses that needed no new one.
+} HudFrameStats;
+
+// fontAtlas is the glyph atlas from createFontAtlas(), laid out in
+// atlasColumns columns of FONTATLAS_GLYPH_WIDTH x FONTATLAS_GLYPH_HEIGHT.
+void hudInit(SDL_Renderer *renderer, SDL_Texture *fontAtlas, int atlasColumns);
+void hudToggle();
+
+void hudPhaseBegin(HudPhase phase);
+void hudPhaseEnd(HudPhase phase);
+void hudTick(double tickMs);
+// Closes the frame: folds phase timings into the averages and appends the
+// frame to the history graphs.
+void hudFrame(double frameMs, const HudFrameStats &stats);
+
+// Draws the overlay, if visible, from the last completed frame.  Away from
+// 1x time the speed and achieved tick rate are shown even when it isn't.
+void hudRender();
+
+#endif /* Hud_h */
@@ -0,0 +1,271 @@
+//
+//  Log.cpp
+//  Asteroids1
+//
+
+#include "Log.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <thread>
+
+static const int LOG_RING_SIZE = 256; // Must be a power of two.
+static const int LOG_MESSAGE_SIZE = 160;
+static const Uint32 LOG_DRAIN_INTERVAL_MS = 10;
+
+typedef struct
+{
+    // Vyukov-style sequence number: equals the slot's index when free for
+    // the producer claiming that index, index + 1 once it holds a message.
+    std::atomic<unsigned int> sequence;
+    LogLevel level;
+    Uint32 ticks;
+    char text[LOG_MESSAGE_SIZE];
+} LogSlot;
+
+static LogSlot gLogRing[LOG_RING_SIZE];
+static std::atomic<unsigned int> gLogHead(0); // Next index to claim.
+static unsigned int gLogTail = 0;             // Next index to drain; writer only.
+static std::atomic<unsigned int> gLogDropped(0);
+static std::atomic<int> gLogMinLevel(LogLevel_Info);
+
+static std::atomic<bool> gLogRunning(false);
+static std::atomic<int> gLogProducers(0); // Callers inside logMessageV.
+static std::thread gLogThread;
+static FILE *gLogFile = nullptr;
+
+static const char *LOG_LEVEL_NAMES[] = { "DEBUG", "INFO", "WARN", "ERROR" };
+
+static void writeSlot(FILE *out, LogLevel level, Uint32 ticks, const char *text)
+{
+    fprintf(out, "[%7.3f] %-5s %s\n", ticks / 1000.0, LOG_LEVEL_NAMES[level], text);
+}
+
+// Returns true if anything was written.
+static bool drainLog(FILE *out)
+{
+    bool wrote = false;
+
+    for (;;)
+    {
+        LogSlot &slot = gLogRing[gLogTail & (LOG_RING_SIZE - 1)];
+
+        if (slot.sequence.load(std::memory_order_acquire) != gLogTail + 1)
+        {
+            break;
+        }
+
+        writeSlot(out, slot.level, slot.ticks, slot.text);
+        slot.sequence.store(gLogTail + LOG_RING_SIZE, std::memory_order_release);
+        gLogTail++;
+        wrote = true;
+    }
+
+    unsigned int dropped = gLogDropped.exchange(0, std::memory_order_relaxed);
+
+    if (dropped > 0)
+    {
+        fprintf(out, "[%7.3f] %-5s %u log messages dropped (ring full)\n",
+                SDL_GetTicks() / 1000.0, LOG_LEVEL_NAMES[LogLevel_Warning], dropped);
+        wrote = true;
+    }
+
+    if (wrote)
+    {
+        fflush(out);
+    }
+
+    return wrote;
+}
+
+static void logThreadMain()
+{
+    while (gLogRunning.load(std::memory_order_acquire))
+    {
+        if (!drainLog(gLogFile))
+        {
+            SDL_Delay(LOG_DRAIN_INTERVAL_MS);
+        }
+    }
+
+    drainLog(gLogFile);
+}
+
+void logInit(const char *path)
+{
+    if (gLogRunning.load())
+    {
+        return;
+    }
+
+    for (int i = 0; i < LOG_RING_SIZE; i++)
+    {
+        gLogRing[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    gLogHead.store(0);
+    gLogTail = 0;
+    gLogFile = stdout;
+
+    if (path != nullptr)
+    {
+        gLogFile = fopen(path, "a");
+
+        if (gLogFile == nullptr)
+        {
+            fprintf(stdout, "Unable to open log file %s, logging to stdout\n", path);
+            gLogFile = stdout;
+        }
+    }
+
+    static bool registered = false;
+
+    if (!registered)
+    {
+        atexit(logQuit);
+        registered = true;
+    }
+
+    gLogRunning.store(true, std::memory_order_release);
+    gLogThread = std::thread(logThreadMain);
+}
+
+void logQuit()
+{
+    if (!gLogRunning.exchange(false))
+    {
+        return;
+    }
+
+    gLogThread.join();
+
+    // A producer that saw gLogRunning before it was cleared may still be
+    // filling its slot; wait for it and write whatever the thread missed.
+    while (gLogProducers.load() != 0)
+    {
+        std::this_thread::yield();
+    }
+
+    drainLog(gLogFile);
+
+    if (gLogFile != stdout)
+    {
+        fclose(gLogFile);
+    }
+
+    gLogFile = nullptr;
+}
+
+void logSetLevel(LogLevel minLevel)
+{
+    gLogMinLevel.store(minLevel, std::memory_order_relaxed);
+}
+
+static void formatMessage(char *text, const char *suffix, const char *format, va_list args)
+{
+    int length = vsnprintf(text, LOG_MESSAGE_SIZE, format, args);
+
+    if (suffix != nullptr && length >= 0 && length < LOG_MESSAGE_SIZE)
+    {
+        snprintf(text + length, LOG_MESSAGE_SIZE - length, "%s", suffix);
+    }
+}
+
+static void logMessageV(LogLevel level, const char *suffix, const char *format, va_list args)
+{
+    Uint32 ticks = SDL_GetTicks();
+
+    // Registering before checking gLogRunning pairs with logQuit clearing it
+    // before waiting on gLogProducers, so no message slips between the two.
+    gLogProducers.fetch_add(1);
+
+    if (!gLogRunning.load())
+    {
+        gLogProducers.fetch_sub(1);
+        char text[LOG_MESSAGE_SIZE];
+        formatMessage(text, suffix, format, args);
+        writeSlot(stdout, level, ticks, text);
+        return;
+    }
+
+    unsigned int index = gLogHead.load(std::memory_order_relaxed);
+    LogSlot *slot;
+
+    for (;;)
+    {
+        slot = &gLogRing[index & (LOG_RING_SIZE - 1)];
+        unsigned int sequence = slot->sequence.load(std::memory_order_acquire);
+        int difference = (int)(sequence - index);
+
+        if (difference == 0)
+        {
+            if (gLogHead.compare_exchange_weak(index, index + 1,
+                                               std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            gLogDropped.fetch_add(1, std::memory_order_relaxed);
+            gLogProducers.fetch_sub(1, std::memory_order_release);
+            return;
+        }
+        else
+        {
+            index = gLogHead.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->level = level;
+    slot->ticks = ticks;
+    formatMessage(slot->text, suffix, format, args);
+    slot->sequence.store(index + 1, std::memory_order_release);
+    gLogProducers.fetch_sub(1, std::memory_order_release);
+}
+
+void logMessage(LogLevel level, const char *format, ...)
+{
+    if (level < gLogMinLevel.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    va_list args;
+    va_start(args, format);
+    logMessageV(level, nullptr, format, args);
+    va_end(args);
+}
+
+void logLimited(LogRateLimit &limit, LogLevel level, const char *format, ...)
+{
+    if (level < gLogMinLevel.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    Uint32 now = SDL_GetTicks();
+
+    if (limit.lastMs != 0 && now - limit.lastMs < limit.intervalMs)
+    {
+        limit.suppressed++;
+        return;
+    }
+
+    char suffix[32] = "";
+
+    if (limit.suppressed > 0)
+    {
+        snprintf(suffix, sizeof(suffix), " (%d suppressed)", limit.suppressed);
+    }
+
+    limit.lastMs = (now == 0) ? 1 : now;
+    limit.suppressed = 0;
+
+    va_list args;
+    va_start(args, format);
+    logMessageV(level, suffix, format, args);
+    va_end(args);
+}
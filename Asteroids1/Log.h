@@ -0,0 +1,47 @@
+//
+//  Log.h
+//  Asteroids1
+//
+//  Leveled logging that is cheap enough to call from the tick loop.
+//  Producers format straight into a slot of a fixed lock-free ring buffer
+//  and return; a background thread drains the ring to stdout or a file.
+//  When the ring is full messages are dropped and counted, never blocked.
+//
+
+#ifndef Log_h
+#define Log_h
+
+#include <SDL2/SDL.h>
+
+typedef enum
+{
+    LogLevel_Debug,
+    LogLevel_Info,
+    LogLevel_Warning,
+    LogLevel_Error
+} LogLevel;
+
+// Per call site state for logLimited().  Not shared between threads.
+typedef struct
+{
+    Uint32 intervalMs;
+    Uint32 lastMs;
+    int suppressed;
+} LogRateLimit;
+
+#define LOG_RATE_LIMIT(intervalMs) { (intervalMs), 0, 0 }
+
+// Starts the writer thread.  path == nullptr logs to stdout.  Messages
+// logged before logInit() or after logQuit() are written synchronously.
+void logInit(const char *path);
+// Drains everything still queued and stops the writer thread.  Safe to
+// call more than once; also registered with atexit() by logInit().
+void logQuit();
+void logSetLevel(LogLevel minLevel);
+
+void logMessage(LogLevel level, const char *format, ...);
+// Like logMessage, but at most once per limit.intervalMs; the next message
+// that gets through reports how many were suppressed in between.
+void logLimited(LogRateLimit &limit, LogLevel level, const char *format, ...);
+
+#endif /* Log_h */
@@ -0,0 +1,112 @@
+//
+//  Real.cpp
+//  Asteroids1
+//
+
+#include "Real.h"
+
+#if ASTEROIDS_FIXED_POINT
+
+#include "TrigTable.h"
+
+// Angles become a phase of 2^32 per turn: phase = raw * TURN_MULTIPLIER >>
+// TURN_SHIFT, with TURN_MULTIPLIER = 2^32 / (2 pi * FIXED_ONE) * 2^TURN_SHIFT
+// rounded.  It is written out rather than computed so no compiler's
+// constant folding can change it.
+static const int TURN_SHIFT = 8;
+static const Sint64 TURN_MULTIPLIER = 42722830;
+
+static const int QUADRANT_BITS = 30;
+static const Uint32 QUADRANT = 1u << QUADRANT_BITS;
+static const int QUARTER_INDEX_BITS = 10; // log2(TRIGTABLE_QUARTER_STEPS)
+static const int INTERPOLATION_BITS = QUADRANT_BITS - QUARTER_INDEX_BITS;
+
+static Uint32 angleToPhase(Real angle)
+{
+    // Wraps modulo one turn; only the low 32 bits of the shifted product
+    // matter, so the shift is done unsigned.
+    return (Uint32)((Uint64)((Sint64)angle.raw * TURN_MULTIPLIER) >> TURN_SHIFT);
+}
+
+// sin over the first quadrant, phase in [0, QUADRANT], with 1.0 = 1 << 30.
+static Sint32 quarterSine(Uint32 phase)
+{
+    Uint32 index = phase >> INTERPOLATION_BITS;
+
+    if (index >= (Uint32)TRIGTABLE_QUARTER_STEPS)
+    {
+        return TRIGTABLE_SINE[TRIGTABLE_QUARTER_STEPS];
+    }
+
+    Sint64 fraction = phase & ((1u << INTERPOLATION_BITS) - 1);
+    Sint64 low = TRIGTABLE_SINE[index];
+    Sint64 high = TRIGTABLE_SINE[index + 1];
+
+    return (Sint32)(low + (((high - low) * fraction) >> INTERPOLATION_BITS));
+}
+
+static Real sineOfPhase(Uint32 phase)
+{
+    Uint32 quadrant = phase >> QUADRANT_BITS;
+    Uint32 quadrantPhase = phase & (QUADRANT - 1);
+
+    if (quadrant & 1)
+    {
+        quadrantPhase = QUADRANT - quadrantPhase;
+    }
+
+    int shift = TRIGTABLE_ONE_BITS - FIXED_FRACTION_BITS;
+    Sint32 raw = (quarterSine(quadrantPhase) + (1 << (shift - 1))) >> shift;
+
+    return Fixed((quadrant & 2) ? -raw : raw);
+}
+
+Real realSin(Real angle)
+{
+    return sineOfPhase(angleToPhase(angle));
+}
+
+Real realCos(Real angle)
+{
+    return sineOfPhase(angleToPhase(angle) + QUADRANT);
+}
+
+// floor(sqrt(value)).  The double square root is only an estimate; the
+// corrections make the result exact, so every build agrees on it however
+// its floating point rounds.  value is at most 2^63 here, so (root + 1)^2
+// can't overflow.
+static Uint64 squareRoot(Uint64 value)
+{
+    Uint64 root = (Uint64)sqrt((double)value);
+
+    while (root * root > value)
+    {
+        root--;
+    }
+
+    while ((root + 1) * (root + 1) <= value)
+    {
+        root++;
+    }
+
+    return root;
+}
+
+Real realSqrt(Real value)
+{
+    if (value.raw <= 0)
+    {
+        return Fixed(0);
+    }
+
+    return Fixed((Sint32)squareRoot((Uint64)value.raw << FIXED_FRACTION_BITS));
+}
+
+Real realLength(Real x, Real y)
+{
+    Uint64 squared = (Uint64)((Sint64)x.raw * x.raw) + (Uint64)((Sint64)y.raw * y.raw);
+
+    return Fixed((Sint32)squareRoot(squared));
+}
+
+#endif
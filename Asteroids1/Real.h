@@ -0,0 +1,150 @@
+//
+//  Real.h
+//  Asteroids1
+//
+//  The simulation's number type.  Normally Real is a float.  Building with
+//  ASTEROIDS_FIXED_POINT=1 makes it Fixed, a 20.12 fixed-point value whose
+//  arithmetic, trig and square root are integer operations, so builds from
+//  different compilers or for different CPUs step the world identically and
+//  lockstep peers only need to exchange input.  Rendering, audio and the
+//  HUD stay in float and convert with realToFloat().
+//
+
+#ifndef Real_h
+#define Real_h
+
+#include <math.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+
+#ifndef ASTEROIDS_FIXED_POINT
+#define ASTEROIDS_FIXED_POINT 0
+#endif
+
+#if ASTEROIDS_FIXED_POINT
+
+static const int FIXED_FRACTION_BITS = 12;
+static const Sint32 FIXED_ONE = 1 << FIXED_FRACTION_BITS;
+
+// There are deliberately no implicit conversions: a float or int slipping
+// into simulation code is a compile error rather than a silent desync.
+// The constructor takes the raw 20.12 value.
+typedef struct Fixed
+{
+    Sint32 raw;
+
+    Fixed() = default;
+    explicit constexpr Fixed(Sint32 rawValue) : raw(rawValue) {}
+} Fixed;
+
+constexpr Fixed operator+(Fixed a, Fixed b) { return Fixed(a.raw + b.raw); }
+constexpr Fixed operator-(Fixed a, Fixed b) { return Fixed(a.raw - b.raw); }
+constexpr Fixed operator-(Fixed a) { return Fixed(-a.raw); }
+// Products round to nearest; quotients truncate toward zero.  Both rely on
+// >> of a negative value being an arithmetic shift, as it is everywhere
+// this builds.
+constexpr Fixed operator*(Fixed a, Fixed b)
+{
+    return Fixed((Sint32)(((Sint64)a.raw * b.raw + FIXED_ONE / 2) >> FIXED_FRACTION_BITS));
+}
+constexpr Fixed operator/(Fixed a, Fixed b)
+{
+    return Fixed((Sint32)((Sint64)a.raw * FIXED_ONE / b.raw));
+}
+constexpr Fixed operator*(Fixed a, int b) { return Fixed(a.raw * b); }
+constexpr Fixed operator*(int a, Fixed b) { return Fixed(a * b.raw); }
+constexpr Fixed operator/(Fixed a, int b) { return Fixed(a.raw / b); }
+
+inline Fixed &operator+=(Fixed &a, Fixed b) { return a = a + b; }
+inline Fixed &operator-=(Fixed &a, Fixed b) { return a = a - b; }
+inline Fixed &operator*=(Fixed &a, Fixed b) { return a = a * b; }
+inline Fixed &operator/=(Fixed &a, Fixed b) { return a = a / b; }
+inline Fixed &operator*=(Fixed &a, int b) { return a = a * b; }
+
+constexpr bool operator==(Fixed a, Fixed b) { return a.raw == b.raw; }
+constexpr bool operator!=(Fixed a, Fixed b) { return a.raw != b.raw; }
+constexpr bool operator<(Fixed a, Fixed b) { return a.raw < b.raw; }
+constexpr bool operator>(Fixed a, Fixed b) { return a.raw > b.raw; }
+constexpr bool operator<=(Fixed a, Fixed b) { return a.raw <= b.raw; }
+constexpr bool operator>=(Fixed a, Fixed b) { return a.raw >= b.raw; }
+
+typedef Fixed Real;
+
+// Stored in scenario files so they can't be loaded by the other build.
+static const Uint32 REAL_FORMAT = 1;
+
+// Multiplying by FIXED_ONE is exact, so this rounds the same way whether
+// the compiler folds it or fuses it into a multiply-add.
+constexpr Real realFromFloat(float value)
+{
+    return Fixed((Sint32)(value * FIXED_ONE + (value < 0 ? -0.5f : 0.5f)));
+}
+constexpr Real realFromInt(int value) { return Fixed(value * FIXED_ONE); }
+inline float realToFloat(Real value) { return value.raw * (1.0f / FIXED_ONE); }
+// Truncates toward zero, like a cast.
+inline int realToInt(Real value) { return value.raw / FIXED_ONE; }
+inline int realFloor(Real value) { return value.raw >> FIXED_FRACTION_BITS; }
+inline Real realAbs(Real value) { return Fixed(value.raw < 0 ? -value.raw : value.raw); }
+inline Uint32 realBits(Real value) { return (Uint32)value.raw; }
+
+// a * b > c * d, compared on the exact 64-bit products so coordinates the
+// size of the window can't overflow.
+inline bool realProductGreater(Real a, Real b, Real c, Real d)
+{
+    return (Sint64)a.raw * b.raw > (Sint64)c.raw * d.raw;
+}
+
+// sqrt(x * x + y * y) > length, on exact squares and without a root.
+inline bool realLengthGreater(Real x, Real y, Real length)
+{
+    return (Uint64)((Sint64)x.raw * x.raw) + (Uint64)((Sint64)y.raw * y.raw) >
+           (Uint64)((Sint64)length.raw * length.raw);
+}
+
+Real realSqrt(Real value);
+// sqrt(x * x + y * y) without overflowing the intermediate squares.
+Real realLength(Real x, Real y);
+// Table based, accurate to about one part in 4096.
+Real realSin(Real angle);
+Real realCos(Real angle);
+
+#else
+
+typedef float Real;
+
+static const Uint32 REAL_FORMAT = 0;
+
+constexpr Real realFromFloat(float value) { return value; }
+constexpr Real realFromInt(int value) { return (float)value; }
+inline float realToFloat(Real value) { return value; }
+inline int realToInt(Real value) { return (int)value; }
+inline int realFloor(Real value) { return (int)floorf(value); }
+inline Real realAbs(Real value) { return fabsf(value); }
+
+inline Uint32 realBits(Real value)
+{
+    Uint32 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline bool realProductGreater(Real a, Real b, Real c, Real d)
+{
+    return a * b > c * d;
+}
+
+inline bool realLengthGreater(Real x, Real y, Real length)
+{
+    return x * x + y * y > length * length;
+}
+
+inline Real realSqrt(Real value) { return sqrtf(value); }
+inline Real realLength(Real x, Real y) { return sqrtf(x * x + y * y); }
+inline Real realSin(Real angle) { return sinf(angle); }
+inline Real realCos(Real angle) { return cosf(angle); }
+
+#endif
+
+static const Real REAL_TWO_PI = realFromFloat(6.28318531f);
+
+#endif /* Real_h */
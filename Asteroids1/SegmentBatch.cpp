@@ -0,0 +1,398 @@
+//
+//  SegmentBatch.cpp
+//  Asteroids1
+//
+
+#include "SegmentBatch.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SEGMENTBATCH_X86 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+// The kernels use AArch64-only intrinsics (vaddvq, vcgtzq, the _high
+// forms), so 32-bit ARM keeps the scalar path.
+#include <arm_neon.h>
+#define SEGMENTBATCH_NEON 1
+#endif
+
+typedef Uint32 (*SegmentBatchKernel)(float ax, float ay, float bx, float by,
+                                     const SegmentBatch &batch);
+typedef Uint32 (*SegmentBatchIntKernel)(Sint32 ax, Sint32 ay, Sint32 bx, Sint32 by,
+                                        const SegmentBatchInt &batch);
+
+// Same expression as counterClockwise() in main.cpp, kept in the same
+// operand order so every kernel rounds identically.
+static inline bool counterClockwise(float ax, float ay, float bx, float by,
+                                    float cx, float cy)
+{
+    return (cy - ay) * (bx - ax) > (by - ay) * (cx - ax);
+}
+
+// In 64 bits, so the query segment may go past SEGMENT_BATCH_INT_LIMIT here.
+static inline bool counterClockwiseInt(Sint64 ax, Sint64 ay, Sint64 bx, Sint64 by,
+                                       Sint64 cx, Sint64 cy)
+{
+    return (cy - ay) * (bx - ax) > (by - ay) * (cx - ax);
+}
+
+static Uint32 countMask(int count)
+{
+    return (count >= 32) ? 0xFFFFFFFFu : ((1u << count) - 1);
+}
+
+Uint32 segmentBatchIntersectScalar(float ax, float ay, float bx, float by,
+                                   const SegmentBatch &batch)
+{
+    Uint32 mask = 0;
+
+    for (int i = 0; i < batch.count; i++)
+    {
+        float cx = batch.x1[i], cy = batch.y1[i];
+        float dx = batch.x2[i], dy = batch.y2[i];
+
+        bool hit = (counterClockwise(ax, ay, cx, cy, dx, dy) !=
+                    counterClockwise(bx, by, cx, cy, dx, dy)) &&
+                   (counterClockwise(ax, ay, bx, by, cx, cy) !=
+                    counterClockwise(ax, ay, bx, by, dx, dy));
+
+        mask |= (Uint32)hit << i;
+    }
+
+    return mask;
+}
+
+Uint32 segmentBatchIntersectIntScalar(Sint32 ax, Sint32 ay, Sint32 bx, Sint32 by,
+                                      const SegmentBatchInt &batch)
+{
+    Uint32 mask = 0;
+
+    for (int i = 0; i < batch.count; i++)
+    {
+        Sint32 cx = batch.y1x1[i * 2 + 1], cy = batch.y1x1[i * 2];
+        Sint32 dx = batch.y2x2[i * 2 + 1], dy = batch.y2x2[i * 2];
+
+        bool hit = (counterClockwiseInt(ax, ay, cx, cy, dx, dy) !=
+                    counterClockwiseInt(bx, by, cx, cy, dx, dy)) &&
+                   (counterClockwiseInt(ax, ay, bx, by, cx, cy) !=
+                    counterClockwiseInt(ax, ay, bx, by, dx, dy));
+
+        mask |= (Uint32)hit << i;
+    }
+
+    return mask;
+}
+
+#if SEGMENTBATCH_X86
+
+__attribute__((target("sse2")))
+static Uint32 segmentBatchIntersectSSE(float ax, float ay, float bx, float by,
+                                       const SegmentBatch &batch)
+{
+    __m128 vax = _mm_set1_ps(ax), vay = _mm_set1_ps(ay);
+    __m128 vbx = _mm_set1_ps(bx), vby = _mm_set1_ps(by);
+    __m128 abx = _mm_sub_ps(vbx, vax), aby = _mm_sub_ps(vby, vay);
+    Uint32 mask = 0;
+
+    for (int i = 0; i < batch.count; i += 4)
+    {
+        __m128 cx = _mm_loadu_ps(batch.x1 + i), cy = _mm_loadu_ps(batch.y1 + i);
+        __m128 dx = _mm_loadu_ps(batch.x2 + i), dy = _mm_loadu_ps(batch.y2 + i);
+
+        // ccw(a, c, d) != ccw(b, c, d)
+        __m128 acd = _mm_cmpgt_ps(_mm_mul_ps(_mm_sub_ps(dy, vay), _mm_sub_ps(cx, vax)),
+                                  _mm_mul_ps(_mm_sub_ps(cy, vay), _mm_sub_ps(dx, vax)));
+        __m128 bcd = _mm_cmpgt_ps(_mm_mul_ps(_mm_sub_ps(dy, vby), _mm_sub_ps(cx, vbx)),
+                                  _mm_mul_ps(_mm_sub_ps(cy, vby), _mm_sub_ps(dx, vbx)));
+        // ccw(a, b, c) != ccw(a, b, d)
+        __m128 abc = _mm_cmpgt_ps(_mm_mul_ps(_mm_sub_ps(cy, vay), abx),
+                                  _mm_mul_ps(aby, _mm_sub_ps(cx, vax)));
+        __m128 abd = _mm_cmpgt_ps(_mm_mul_ps(_mm_sub_ps(dy, vay), abx),
+                                  _mm_mul_ps(aby, _mm_sub_ps(dx, vax)));
+
+        __m128 hit = _mm_and_ps(_mm_xor_ps(acd, bcd), _mm_xor_ps(abc, abd));
+        mask |= (Uint32)_mm_movemask_ps(hit) << i;
+    }
+
+    return mask & countMask(batch.count);
+}
+
+__attribute__((target("avx2")))
+static Uint32 segmentBatchIntersectAVX2(float ax, float ay, float bx, float by,
+                                        const SegmentBatch &batch)
+{
+    __m256 vax = _mm256_set1_ps(ax), vay = _mm256_set1_ps(ay);
+    __m256 vbx = _mm256_set1_ps(bx), vby = _mm256_set1_ps(by);
+    __m256 abx = _mm256_sub_ps(vbx, vax), aby = _mm256_sub_ps(vby, vay);
+    Uint32 mask = 0;
+
+    for (int i = 0; i < batch.count; i += 8)
+    {
+        __m256 cx = _mm256_loadu_ps(batch.x1 + i), cy = _mm256_loadu_ps(batch.y1 + i);
+        __m256 dx = _mm256_loadu_ps(batch.x2 + i), dy = _mm256_loadu_ps(batch.y2 + i);
+
+        __m256 acd = _mm256_cmp_ps(_mm256_mul_ps(_mm256_sub_ps(dy, vay), _mm256_sub_ps(cx, vax)),
+                                   _mm256_mul_ps(_mm256_sub_ps(cy, vay), _mm256_sub_ps(dx, vax)),
+                                   _CMP_GT_OQ);
+        __m256 bcd = _mm256_cmp_ps(_mm256_mul_ps(_mm256_sub_ps(dy, vby), _mm256_sub_ps(cx, vbx)),
+                                   _mm256_mul_ps(_mm256_sub_ps(cy, vby), _mm256_sub_ps(dx, vbx)),
+                                   _CMP_GT_OQ);
+        __m256 abc = _mm256_cmp_ps(_mm256_mul_ps(_mm256_sub_ps(cy, vay), abx),
+                                   _mm256_mul_ps(aby, _mm256_sub_ps(cx, vax)),
+                                   _CMP_GT_OQ);
+        __m256 abd = _mm256_cmp_ps(_mm256_mul_ps(_mm256_sub_ps(dy, vay), abx),
+                                   _mm256_mul_ps(aby, _mm256_sub_ps(dx, vax)),
+                                   _CMP_GT_OQ);
+
+        __m256 hit = _mm256_and_ps(_mm256_xor_ps(acd, bcd), _mm256_xor_ps(abc, abd));
+        mask |= (Uint32)_mm256_movemask_ps(hit) << i;
+    }
+
+    return mask & countMask(batch.count);
+}
+
+// pmaddwd turns each pair of 16-bit lanes into u1 * v1 + u2 * v2, so with
+// the batch's interleaved layout every cross product is one subtract and
+// one multiply-add:
+//   acd = ((y2, y1) - (ay, ay)) . ((x1, -x2) - (ax, -ax))
+//   bcd = the same around b
+//   abc = ((y1, x1) - (ay, ax)) . (bx - ax, ay - by)
+//   abd = ((y2, x2) - (ay, ax)) . (bx - ax, ay - by)
+// A positive result means counter-clockwise, as in counterClockwiseInt.
+__attribute__((target("sse2")))
+static Uint32 segmentBatchIntersectIntSSE(Sint32 ax, Sint32 ay, Sint32 bx, Sint32 by,
+                                          const SegmentBatchInt &batch)
+{
+    // Built from broadcasts and unpacks; packing the pairs in scalar
+    // registers costs as much as the loop itself.
+    __m128i zero = _mm_setzero_si128();
+    __m128i vax = _mm_set1_epi16((Sint16)ax), vay = _mm_set1_epi16((Sint16)ay);
+    __m128i vbx = _mm_set1_epi16((Sint16)bx), vby = _mm_set1_epi16((Sint16)by);
+    __m128i aa = vay, ba = vby;
+    __m128i ac = _mm_unpacklo_epi16(vax, _mm_sub_epi16(zero, vax));
+    __m128i bc = _mm_unpacklo_epi16(vbx, _mm_sub_epi16(zero, vbx));
+    __m128i ayx = _mm_unpacklo_epi16(vay, vax);
+    __m128i ab = _mm_unpacklo_epi16(_mm_sub_epi16(vbx, vax), _mm_sub_epi16(vay, vby));
+    Uint32 mask = 0;
+
+    for (int i = 0; i < batch.count; i += 4)
+    {
+        __m128i y2y1 = _mm_loadu_si128((const __m128i *)(batch.y2y1 + i * 2));
+        __m128i x1x2 = _mm_loadu_si128((const __m128i *)(batch.x1x2 + i * 2));
+        __m128i y1x1 = _mm_loadu_si128((const __m128i *)(batch.y1x1 + i * 2));
+        __m128i y2x2 = _mm_loadu_si128((const __m128i *)(batch.y2x2 + i * 2));
+
+        __m128i acd = _mm_cmpgt_epi32(_mm_madd_epi16(_mm_sub_epi16(y2y1, aa),
+                                                     _mm_sub_epi16(x1x2, ac)), zero);
+        __m128i bcd = _mm_cmpgt_epi32(_mm_madd_epi16(_mm_sub_epi16(y2y1, ba),
+                                                     _mm_sub_epi16(x1x2, bc)), zero);
+        __m128i abc = _mm_cmpgt_epi32(_mm_madd_epi16(_mm_sub_epi16(y1x1, ayx), ab), zero);
+        __m128i abd = _mm_cmpgt_epi32(_mm_madd_epi16(_mm_sub_epi16(y2x2, ayx), ab), zero);
+
+        __m128i hit = _mm_and_si128(_mm_xor_si128(acd, bcd), _mm_xor_si128(abc, abd));
+        mask |= (Uint32)_mm_movemask_ps(_mm_castsi128_ps(hit)) << i;
+    }
+
+    return mask & countMask(batch.count);
+}
+
+__attribute__((target("avx2")))
+static Uint32 segmentBatchIntersectIntAVX2(Sint32 ax, Sint32 ay, Sint32 bx, Sint32 by,
+                                           const SegmentBatchInt &batch)
+{
+    __m256i zero = _mm256_setzero_si256();
+    __m256i vax = _mm256_set1_epi16((Sint16)ax), vay = _mm256_set1_epi16((Sint16)ay);
+    __m256i vbx = _mm256_set1_epi16((Sint16)bx), vby = _mm256_set1_epi16((Sint16)by);
+    __m256i aa = vay, ba = vby;
+    __m256i ac = _mm256_unpacklo_epi16(vax, _mm256_sub_epi16(zero, vax));
+    __m256i bc = _mm256_unpacklo_epi16(vbx, _mm256_sub_epi16(zero, vbx));
+    __m256i ayx = _mm256_unpacklo_epi16(vay, vax);
+    __m256i ab = _mm256_unpacklo_epi16(_mm256_sub_epi16(vbx, vax), _mm256_sub_epi16(vay, vby));
+    Uint32 mask = 0;
+
+    for (int i = 0; i < batch.count; i += 8)
+    {
+        __m256i y2y1 = _mm256_loadu_si256((const __m256i *)(batch.y2y1 + i * 2));
+        __m256i x1x2 = _mm256_loadu_si256((const __m256i *)(batch.x1x2 + i * 2));
+        __m256i y1x1 = _mm256_loadu_si256((const __m256i *)(batch.y1x1 + i * 2));
+        __m256i y2x2 = _mm256_loadu_si256((const __m256i *)(batch.y2x2 + i * 2));
+
+        __m256i acd = _mm256_cmpgt_epi32(_mm256_madd_epi16(_mm256_sub_epi16(y2y1, aa),
+                                                           _mm256_sub_epi16(x1x2, ac)), zero);
+        __m256i bcd = _mm256_cmpgt_epi32(_mm256_madd_epi16(_mm256_sub_epi16(y2y1, ba),
+                                                           _mm256_sub_epi16(x1x2, bc)), zero);
+        __m256i abc = _mm256_cmpgt_epi32(_mm256_madd_epi16(_mm256_sub_epi16(y1x1, ayx), ab),
+                                         zero);
+        __m256i abd = _mm256_cmpgt_epi32(_mm256_madd_epi16(_mm256_sub_epi16(y2x2, ayx), ab),
+                                         zero);
+
+        __m256i hit = _mm256_and_si256(_mm256_xor_si256(acd, bcd), _mm256_xor_si256(abc, abd));
+        mask |= (Uint32)_mm256_movemask_ps(_mm256_castsi256_ps(hit)) << i;
+    }
+
+    return mask & countMask(batch.count);
+}
+
+#endif
+
+#if SEGMENTBATCH_NEON
+
+static Uint32 segmentBatchIntersectNEON(float ax, float ay, float bx, float by,
+                                        const SegmentBatch &batch)
+{
+    float32x4_t vax = vdupq_n_f32(ax), vay = vdupq_n_f32(ay);
+    float32x4_t vbx = vdupq_n_f32(bx), vby = vdupq_n_f32(by);
+    float32x4_t abx = vsubq_f32(vbx, vax), aby = vsubq_f32(vby, vay);
+    static const uint32_t laneBits[4] = { 1, 2, 4, 8 };
+    uint32x4_t bits = vld1q_u32(laneBits);
+    Uint32 mask = 0;
+
+    for (int i = 0; i < batch.count; i += 4)
+    {
+        float32x4_t cx = vld1q_f32(batch.x1 + i), cy = vld1q_f32(batch.y1 + i);
+        float32x4_t dx = vld1q_f32(batch.x2 + i), dy = vld1q_f32(batch.y2 + i);
+
+        uint32x4_t acd = vcgtq_f32(vmulq_f32(vsubq_f32(dy, vay), vsubq_f32(cx, vax)),
+                                   vmulq_f32(vsubq_f32(cy, vay), vsubq_f32(dx, vax)));
+        uint32x4_t bcd = vcgtq_f32(vmulq_f32(vsubq_f32(dy, vby), vsubq_f32(cx, vbx)),
+                                   vmulq_f32(vsubq_f32(cy, vby), vsubq_f32(dx, vbx)));
+        uint32x4_t abc = vcgtq_f32(vmulq_f32(vsubq_f32(cy, vay), abx),
+                                   vmulq_f32(aby, vsubq_f32(cx, vax)));
+        uint32x4_t abd = vcgtq_f32(vmulq_f32(vsubq_f32(dy, vay), abx),
+                                   vmulq_f32(aby, vsubq_f32(dx, vax)));
+
+        uint32x4_t hit = vandq_u32(veorq_u32(acd, bcd), veorq_u32(abc, abd));
+        mask |= vaddvq_u32(vandq_u32(hit, bits)) << i;
+    }
+
+    return mask & countMask(batch.count);
+}
+
+// vld2 undoes the interleaving on load; each cross product is then a
+// widening multiply and multiply-subtract per half.
+static inline uint32x4_t crossSignsLowNEON(int16x8_t u1, int16x8_t v1, int16x8_t u2, int16x8_t v2)
+{
+    return vcgtzq_s32(vmlsl_s16(vmull_s16(vget_low_s16(u1), vget_low_s16(v1)),
+                                vget_low_s16(u2), vget_low_s16(v2)));
+}
+
+static inline uint32x4_t crossSignsHighNEON(int16x8_t u1, int16x8_t v1, int16x8_t u2, int16x8_t v2)
+{
+    return vcgtzq_s32(vmlsl_high_s16(vmull_high_s16(u1, v1), u2, v2));
+}
+
+static Uint32 segmentBatchIntersectIntNEON(Sint32 ax, Sint32 ay, Sint32 bx, Sint32 by,
+                                           const SegmentBatchInt &batch)
+{
+    int16x8_t vax = vdupq_n_s16((Sint16)ax), vay = vdupq_n_s16((Sint16)ay);
+    int16x8_t vbx = vdupq_n_s16((Sint16)bx), vby = vdupq_n_s16((Sint16)by);
+    int16x8_t abx = vsubq_s16(vbx, vax), aby = vsubq_s16(vby, vay);
+    static const uint32_t laneBits[4] = { 1, 2, 4, 8 };
+    uint32x4_t bits = vld1q_u32(laneBits);
+    Uint32 mask = 0;
+
+    for (int i = 0; i < batch.count; i += 8)
+    {
+        int16x8x2_t first = vld2q_s16(batch.y1x1 + i * 2);
+        int16x8x2_t second = vld2q_s16(batch.y2x2 + i * 2);
+        int16x8_t cy = first.val[0], cx = first.val[1];
+        int16x8_t dy = second.val[0], dx = second.val[1];
+
+        int16x8_t cxa = vsubq_s16(cx, vax), cya = vsubq_s16(cy, vay);
+        int16x8_t dxa = vsubq_s16(dx, vax), dya = vsubq_s16(dy, vay);
+        int16x8_t cxb = vsubq_s16(cx, vbx), cyb = vsubq_s16(cy, vby);
+        int16x8_t dxb = vsubq_s16(dx, vbx), dyb = vsubq_s16(dy, vby);
+
+        uint32x4_t hitLow = vandq_u32(
+            veorq_u32(crossSignsLowNEON(dya, cxa, cya, dxa), crossSignsLowNEON(dyb, cxb, cyb, dxb)),
+            veorq_u32(crossSignsLowNEON(cya, abx, aby, cxa), crossSignsLowNEON(dya, abx, aby, dxa)));
+        uint32x4_t hitHigh = vandq_u32(
+            veorq_u32(crossSignsHighNEON(dya, cxa, cya, dxa), crossSignsHighNEON(dyb, cxb, cyb, dxb)),
+            veorq_u32(crossSignsHighNEON(cya, abx, aby, cxa), crossSignsHighNEON(dya, abx, aby, dxa)));
+
+        mask |= (vaddvq_u32(vandq_u32(hitLow, bits)) |
+                 vaddvq_u32(vandq_u32(hitHigh, bits)) << 4) << i;
+    }
+
+    return mask & countMask(batch.count);
+}
+
+#endif
+
+static SegmentBatchKernel gKernel = nullptr;
+static const char *gKernelName = nullptr;
+static SegmentBatchIntKernel gIntKernel = nullptr;
+static const char *gIntKernelName = nullptr;
+
+static void selectKernel()
+{
+    gKernel = segmentBatchIntersectScalar;
+    gKernelName = "scalar";
+    gIntKernel = segmentBatchIntersectIntScalar;
+    gIntKernelName = "int scalar";
+
+#if SEGMENTBATCH_X86
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2"))
+    {
+        gKernel = segmentBatchIntersectAVX2;
+        gKernelName = "avx2";
+        gIntKernel = segmentBatchIntersectIntAVX2;
+        gIntKernelName = "int avx2";
+    }
+    else if (__builtin_cpu_supports("sse2"))
+    {
+        gKernel = segmentBatchIntersectSSE;
+        gKernelName = "sse2";
+        gIntKernel = segmentBatchIntersectIntSSE;
+        gIntKernelName = "int sse2";
+    }
+#elif SEGMENTBATCH_NEON
+    gKernel = segmentBatchIntersectNEON;
+    gKernelName = "neon";
+    gIntKernel = segmentBatchIntersectIntNEON;
+    gIntKernelName = "int neon";
+#endif
+}
+
+Uint32 segmentBatchIntersect(float ax, float ay, float bx, float by,
+                             const SegmentBatch &batch)
+{
+    if (gKernel == nullptr)
+    {
+        selectKernel();
+    }
+
+    return gKernel(ax, ay, bx, by, batch);
+}
+
+const char *segmentBatchKernelName()
+{
+    if (gKernel == nullptr)
+    {
+        selectKernel();
+    }
+
+    return gKernelName;
+}
+
+Uint32 segmentBatchIntersectInt(Sint32 ax, Sint32 ay, Sint32 bx, Sint32 by,
+                                const SegmentBatchInt &batch)
+{
+    if (gIntKernel == nullptr)
+    {
+        selectKernel();
+    }
+
+    return gIntKernel(ax, ay, bx, by, batch);
+}
+
+const char *segmentBatchIntKernelName()
+{
+    if (gIntKernel == nullptr)
+    {
+        selectKernel();
+    }
+
+    return gIntKernelName;
+}
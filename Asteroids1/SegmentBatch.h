@@ -0,0 +1,77 @@
+//
+//  SegmentBatch.h
+//  Asteroids1
+//
+//  Tests one segment against up to SEGMENT_BATCH_SIZE edges at once.  The
+//  edges are stored already translated into world space, one array per
+//  coordinate, so the kernel can load eight (AVX2) or four (SSE2/NEON)
+//  of them per instruction.  The result matches linesIntersect() for each
+//  edge and comes back as a bit mask.
+//
+//  SegmentBatchInt is the same test on integers for the fixed-point build.
+//  Its coordinates must stay below SEGMENT_BATCH_INT_LIMIT in magnitude, so
+//  every difference fits in 16 bits and every cross product in 32; callers
+//  work relative to a nearby origin.  Edges are stored as interleaved
+//  16-bit pairs, laid out so each cross product is a single multiply-add
+//  of two pairs with no shuffling.
+//
+
+#ifndef SegmentBatch_h
+#define SegmentBatch_h
+
+#include <SDL2/SDL.h>
+
+static const int SEGMENT_BATCH_SIZE = 16;
+
+typedef struct
+{
+    alignas(32) float x1[SEGMENT_BATCH_SIZE];
+    alignas(32) float y1[SEGMENT_BATCH_SIZE];
+    alignas(32) float x2[SEGMENT_BATCH_SIZE];
+    alignas(32) float y2[SEGMENT_BATCH_SIZE];
+    int count;
+} SegmentBatch;
+
+// Bit i is set when segment (ax, ay)-(bx, by) crosses edge i of the batch.
+// Uses the widest kernel the CPU supports.
+Uint32 segmentBatchIntersect(float ax, float ay, float bx, float by,
+                             const SegmentBatch &batch);
+// Portable reference version of the same test.
+Uint32 segmentBatchIntersectScalar(float ax, float ay, float bx, float by,
+                                   const SegmentBatch &batch);
+const char *segmentBatchKernelName();
+
+static const Sint32 SEGMENT_BATCH_INT_LIMIT = 1 << 14;
+
+// Fill with segmentBatchIntSet() rather than directly.
+typedef struct
+{
+    alignas(32) Sint16 y2y1[SEGMENT_BATCH_SIZE * 2]; // (y2, y1) per edge
+    alignas(32) Sint16 x1x2[SEGMENT_BATCH_SIZE * 2]; // (x1, -x2)
+    alignas(32) Sint16 y1x1[SEGMENT_BATCH_SIZE * 2]; // (y1, x1)
+    alignas(32) Sint16 y2x2[SEGMENT_BATCH_SIZE * 2]; // (y2, x2)
+    int count;
+} SegmentBatchInt;
+
+inline void segmentBatchIntSet(SegmentBatchInt &batch, int i,
+                               Sint32 x1, Sint32 y1, Sint32 x2, Sint32 y2)
+{
+    batch.y2y1[i * 2] = (Sint16)y2;
+    batch.y2y1[i * 2 + 1] = (Sint16)y1;
+    batch.x1x2[i * 2] = (Sint16)x1;
+    batch.x1x2[i * 2 + 1] = (Sint16)-x2;
+    batch.y1x1[i * 2] = (Sint16)y1;
+    batch.y1x1[i * 2 + 1] = (Sint16)x1;
+    batch.y2x2[i * 2] = (Sint16)y2;
+    batch.y2x2[i * 2 + 1] = (Sint16)x2;
+}
+
+Uint32 segmentBatchIntersectInt(Sint32 ax, Sint32 ay, Sint32 bx, Sint32 by,
+                                const SegmentBatchInt &batch);
+// Only the batch has to respect SEGMENT_BATCH_INT_LIMIT here, so this also
+// handles query segments too long for the SIMD kernels.
+Uint32 segmentBatchIntersectIntScalar(Sint32 ax, Sint32 ay, Sint32 bx, Sint32 by,
+                                      const SegmentBatchInt &batch);
+const char *segmentBatchIntKernelName();
+
+#endif /* SegmentBatch_h */
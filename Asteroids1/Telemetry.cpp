@@ -0,0 +1,116 @@
+//
+//  Telemetry.cpp
+//  Asteroids1
+//
+
+#include "Telemetry.h"
+#include "Log.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static TelemetryRegion *gRegion = nullptr;
+static char gRegionName[64];
+
+static void writeSlot(TelemetrySlot &slot, const TelemetrySample &sample)
+{
+    uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.sample = sample;
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool telemetryInit(const char *name)
+{
+    // Exclusive, so a second instance can't take over a region that a
+    // running game and its readers are using.
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+
+    if (fd < 0 && errno == EEXIST)
+    {
+        logMessage(LogLevel_Warning,
+                   "Telemetry region %s already exists: another instance is publishing to it, "
+                   "or a run that crashed left it behind (telemetry-reader --remove deletes it)",
+                   name);
+        return false;
+    }
+
+    if (fd < 0)
+    {
+        logMessage(LogLevel_Warning, "Unable to open telemetry region %s: %s",
+                   name, strerror(errno));
+        return false;
+    }
+
+    if (ftruncate(fd, sizeof(TelemetryRegion)) < 0)
+    {
+        logMessage(LogLevel_Warning, "Unable to size telemetry region %s: %s",
+                   name, strerror(errno));
+        close(fd);
+        shm_unlink(name);
+        return false;
+    }
+
+    void *memory = mmap(nullptr, sizeof(TelemetryRegion), PROT_READ | PROT_WRITE,
+                        MAP_SHARED, fd, 0);
+    int error = errno;
+    close(fd);
+
+    if (memory == MAP_FAILED)
+    {
+        logMessage(LogLevel_Warning, "Unable to map telemetry region %s: %s",
+                   name, strerror(error));
+        shm_unlink(name);
+        return false;
+    }
+
+    // Fresh pages are zero, which is a valid state for every atomic here.
+    // Touching them all now keeps page faults out of the tick loop.
+    gRegion = (TelemetryRegion *)memory;
+    memset((void *)gRegion, 0, sizeof(TelemetryRegion));
+    gRegion->version = TELEMETRY_VERSION;
+    gRegion->sampleSize = sizeof(TelemetrySample);
+    gRegion->ringSize = TELEMETRY_RING_SIZE;
+    gRegion->running.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    gRegion->magic = TELEMETRY_MAGIC;
+
+    strncpy(gRegionName, name, sizeof(gRegionName) - 1);
+    logMessage(LogLevel_Info, "Telemetry: %s, %d bytes", name, (int)sizeof(TelemetryRegion));
+
+    return true;
+}
+
+void telemetryQuit()
+{
+    if (gRegion == nullptr)
+    {
+        return;
+    }
+
+    // Readers that already have it mapped keep their view and see running
+    // drop to 0; the name goes away so the next run starts clean.
+    gRegion->running.store(0, std::memory_order_release);
+    munmap(gRegion, sizeof(TelemetryRegion));
+    shm_unlink(gRegionName);
+    gRegion = nullptr;
+}
+
+void telemetryPublish(const TelemetrySample &sample)
+{
+    if (gRegion == nullptr)
+    {
+        return;
+    }
+
+    writeSlot(gRegion->latest, sample);
+
+    uint64_t written = gRegion->written.load(std::memory_order_relaxed);
+    writeSlot(gRegion->ring[written % TELEMETRY_RING_SIZE], sample);
+    gRegion->written.store(written + 1, std::memory_order_release);
+}
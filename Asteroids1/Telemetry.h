@@ -0,0 +1,86 @@
+//
+//  Telemetry.h
+//  Asteroids1
+//
+//  Optional live telemetry in a POSIX shared-memory region, for dashboards
+//  running in another process.  The game publishes one sample per tick with
+//  plain stores: the latest sample sits behind a seqlock, and every sample
+//  is also appended to a ring so a reader polling slower than 60 Hz can
+//  still see each tick.  Readers never block the game; a reader that falls
+//  more than a ring's worth behind skips ahead and counts the gap.
+//
+//  This header is shared with Tools/telemetry-reader.cpp, so it sticks to
+//  fixed-width types and doesn't pull in SDL.
+//
+
+#ifndef Telemetry_h
+#define Telemetry_h
+
+#include <stdint.h>
+#include <atomic>
+
+static const char TELEMETRY_DEFAULT_NAME[] = "/asteroids-telemetry";
+static const uint32_t TELEMETRY_MAGIC = 0x54534141; // "AAST"
+static const uint32_t TELEMETRY_VERSION = 1;
+static const int TELEMETRY_RING_SIZE = 1024;         // About 17 seconds of ticks.
+
+typedef struct
+{
+    uint64_t tick;
+    double tickMs;
+    double frameMs;             // Last completed frame.
+    uint32_t asteroids;
+    uint32_t projectiles;
+    uint32_t particles;
+    int32_t state;              // GameState.
+    float shipX;
+    float shipY;
+    float shipAngle;
+    float shipSpeed;
+} TelemetrySample;
+
+// An odd sequence means a write is in progress.
+typedef struct
+{
+    std::atomic<uint32_t> sequence;
+    TelemetrySample sample;
+} TelemetrySlot;
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t sampleSize;
+    uint32_t ringSize;
+    std::atomic<uint32_t> running;      // Cleared when the game exits.
+    TelemetrySlot latest;
+    std::atomic<uint64_t> written;      // Samples ever appended to the ring.
+    TelemetrySlot ring[TELEMETRY_RING_SIZE];
+} TelemetryRegion;
+
+// Seqlock read of one slot; false if the writer was mid-update.
+static inline bool telemetryReadSlot(const TelemetrySlot &slot, TelemetrySample *sample)
+{
+    uint32_t before = slot.sequence.load(std::memory_order_acquire);
+
+    if (before & 1)
+    {
+        return false;
+    }
+
+    *sample = slot.sample;
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    return slot.sequence.load(std::memory_order_relaxed) == before;
+}
+
+// Creates and maps the region; false (with a log message) if the platform
+// refuses or the name is already taken.  name must start with '/'.
+// telemetryQuit() removes the name again, so every exit path should call
+// it.
+bool telemetryInit(const char *name);
+void telemetryQuit();
+// Publishes one sample.  Does nothing unless telemetryInit() succeeded.
+void telemetryPublish(const TelemetrySample &sample);
+
+#endif /* Telemetry_h */
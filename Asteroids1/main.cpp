@@ -6,15 +6,32 @@
 //  Copyright © 2016 centuryapps. All rights reserved.
 //
 
+#include <errno.h>
+#include <fcntl.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
 #include <iostream>
 #include <vector>
 #include <SDL2/SDL.h>
-#include <SDL2_ttf/SDL_ttf.h>
+#include "Alloc.h"
+#include "Audio.h"
+#include "FontAtlas.h"
+#include "Hud.h"
+#include "Log.h"
+#include "Real.h"
+#include "SegmentBatch.h"
+#include "Telemetry.h"
 
+// Still called Vector2f, but its components are Real: float normally and
+// fixed point in a deterministic build.
 typedef struct
 {
-    float x, y;
+    Real x, y;
 } Vector2f;
 
 typedef struct
@@ -25,15 +42,20 @@ typedef struct
 typedef struct
 {
     // Ax + By = C
-    float a, b, c;
+    Real a, b, c;
 } LineEquation;
 
-static const int N_LINES = 5;
+static const int MIN_POLYGON_VERTICES = 8;
+static const int MAX_POLYGON_VERTICES = 16;
 
+// Radial polygon: vertex i sits radii[i] pixels from the center at angle
+// i * 2pi / nVertices (plus the owner's rotation).  Each vertex is stored
+// once and edges are implied by consecutive vertices, so a 16-vertex rock
+// takes less memory than the old five duplicated-endpoint lines.
 typedef struct
 {
-    int nLines;
-    Line lines[N_LINES];
+    Uint8 nVertices;
+    Uint8 radii[MAX_POLYGON_VERTICES];
 } Polygon;
 
 typedef int AsteroidSize;
@@ -43,9 +65,10 @@ typedef struct
     AsteroidSize size;
     Vector2f position;
     Vector2f velocity;
-    float angle;
-    float angularVelocity;
+    Real angle;
+    Real angularVelocity;
     Polygon shape;
+    Uint8 variant; // Which of its size's stock outlines shape is.
 } Asteroid;
 
 static const AsteroidSize ASTEROIDSIZE_SMALL = 10;
@@ -55,16 +78,55 @@ static const int ASTEROIDVEL_SMALL = 3;
 static const int ASTEROIDVEL_MEDIUM = 2;
 static const int ASTEROIDVEL_LARGE = 1;
 static const int N_INIT_ASTEROIDS = 10;
+// Reserved up front so splitting never reallocates mid-tick; a full game
+// peaks at 40 small asteroids.
+static const int ASTEROID_CAPACITY = 256;
+// Vertex radii are drawn from [size * MIN, size * MAX] to make jagged rocks.
+static const Real ASTEROID_RADIUS_MIN = realFromFloat(0.75f);
+static const Real ASTEROID_RADIUS_MAX = realFromFloat(1.15f);
+static const Real ASTEROID_ANGULARSPEED = realFromFloat(0.02f);
+// Outlines come from a small fixed set per size, generated from their own
+// seed at startup, so the sprite atlas can hold every one pre-rasterized.
+static const int N_ASTEROID_SIZES = 3;
+static const int ASTEROID_VARIANTS = 4;
+static const Uint32 ASTEROID_SHAPE_SEED = 0x5eed;
+
+// Sweep-and-prune runs along x inside horizontal bands one maximum
+// asteroid diameter tall, so two rocks can only touch if their centers sit
+// in the same or neighbouring bands.  A single sweep over the whole field
+// would scan every rock in a full-height strip, which grows with the square
+// root of the asteroid count.
+static const Real ASTEROID_SWEEP_BAND = 2 * ASTEROIDSIZE_LARGE * ASTEROID_RADIUS_MAX;
+
+// One entry per asteroid, kept sorted by band and then minX from tick to
+// tick.
+typedef struct
+{
+    int band;
+    Real minX, maxX;
+    Real minY, maxY;
+    int index;
+} SweepEntry;
 
 static const int N_SHIP_LINES = 3;
+// Bounds the outline below.  The rotated copy can come out a fraction of
+// a fixed-point unit longer, which the sector padding in the SAT absorbs.
+static const Real SHIP_RADIUS = realFromInt(10);
+// The ship at angle 0, nose along +x.  ship.lines is this rotated by
+// ship.angle, rebuilt every tick so rounding can't build up.
+static const Line SHIP_OUTLINE[N_SHIP_LINES] = {
+    { { realFromInt(10), realFromInt(0) }, { realFromInt(-8), realFromInt(-5) } },
+    { { realFromInt(-8), realFromInt(-5) }, { realFromInt(-8), realFromInt(5) } },
+    { { realFromInt(-8), realFromInt(5) }, { realFromInt(10), realFromInt(0) } }
+};
 
 typedef struct
 {
     Vector2f position;
     Vector2f velocity;
-    float speed;
-    float thrust;
-    float angle;
+    Real speed;
+    Real thrust;
+    Real angle;
     Line lines[N_SHIP_LINES];
     bool turnLeft;
     bool turnRight;
@@ -83,11 +145,51 @@ typedef struct
 static const int PROJECTILE_SIZE = 2;
 static const int PROJECTILE_LIFETIME = 1.5 * 1000; // Milliseconds
 static const int PROJECTILE_COOLDOWN = 0.05 * 1000; // Milliseconds
-static const float PROJECTILE_SPEED = 8.0f;
+static const Real PROJECTILE_SPEED = realFromInt(8);
+static const int PARTICLE_LIFETIME = 0.5 * 1000; // Milliseconds
+static const Real PARTICLE_SPEED = realFromInt(2);
+// Firing peaks around 25 live projectiles, and each explosion adds 10
+// particles for half a second.
+static const int PROJECTILE_CAPACITY = 256;
+static const int PARTICLE_CAPACITY = 2048;
+
+// Scenario files are the world's arrays written out as they sit in memory,
+// each 64-byte aligned after a fixed header, so loading is an mmap and one
+// copy per array.  The struct sizes are stored to catch stale files, but
+// bump SCENARIO_VERSION whenever Asteroid, Ship or Projectile change.
+// Files use the writer's byte order.
+static const char SCENARIO_MAGIC[4] = { 'A', 'S', 'C', 'N' };
+static const Uint32 SCENARIO_VERSION = 2;
+static const Uint64 SCENARIO_ALIGNMENT = 64;
+// Bounces trade speed between rocks, so a small one can leave a crowd
+// faster than it spawned; 5000-tick runs of dense fields peak around 9
+// pixels per tick.  Well past that, but short of where the fixed-point
+// bounce math would overflow.
+static const Real SCENARIO_ASTEROID_SPEED_MAX = realFromInt(32);
+
+typedef struct
+{
+    char magic[4];
+    Uint32 version;
+    Uint32 asteroidSize;
+    Uint32 shipSize;
+    Uint32 projectileSize;
+    Sint32 state;
+    Uint32 ticks;
+    Uint32 realFormat; // REAL_FORMAT of the build that wrote it.
+    Uint64 fileSize;
+    Uint64 asteroidOffset, nAsteroids;
+    Uint64 shipOffset;
+    Uint64 projectileOffset, nProjectiles;
+    Uint64 particleOffset, nParticles;
+} ScenarioHeader;
 
-static const float SHIP_MAXSPEED = 4.0f;
-static const float SHIP_THRUST = 0.05f;
-static const float SHIP_ANGULARSPEED = 0.05f;
+static const Real SHIP_MAXSPEED = realFromInt(4);
+static const Real SHIP_THRUST = realFromFloat(0.05f);
+static const Real SHIP_ANGULARSPEED = realFromFloat(0.05f);
+static const Real SHIP_DRAG = realFromFloat(0.99f);
+static const Real SHIP_SPEED_DECAY = realFromFloat(0.9f);
+static const Real SHIP_REST_SPEED = realFromFloat(0.005f);
 
 static const int WRAPBUFFER_X = 10;
 static const int WRAPBUFFER_Y = 10;
@@ -99,7 +201,81 @@ static const int WINDOW_WIDTH = 1024;
 static const int WINDOW_HEIGHT = 1024;
 static const Uint32 WINDOW_FLAGS = 0;
 static const Uint32 RENDERER_FLAGS = SDL_RENDERER_ACCELERATED |
-                                     SDL_RENDERER_PRESENTVSYNC;
+                                     SDL_RENDERER_PRESENTVSYNC |
+                                     SDL_RENDERER_TARGETTEXTURE;
+// Only what the game uses; SDL_INIT_EVERYTHING also brings up joystick,
+// haptic and game controller support at a noticeable startup cost.
+static const Uint32 SDL_SUBSYSTEMS = SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_AUDIO;
+
+// Integer collision edges sit on a 1/64 pixel grid, numbered from their
+// asteroid's center; see SEGMENT_BATCH_INT_LIMIT.
+static const int EDGE_GRID_BITS = 6;
+
+// Collision edges in the form this build's segment kernel takes: world
+// space floats, or grid integers numbered from origin in the fixed-point
+// build, where radius bounds every vertex.
+typedef struct
+{
+#if ASTEROIDS_FIXED_POINT
+    SegmentBatchInt batch;
+    Vector2f origin;
+    Real radius;
+#else
+    SegmentBatch batch;
+#endif
+} AsteroidEdges;
+
+// An asteroid's outline in world space, worked out the first time a tick
+// needs it: when the asteroid is a collision candidate or drawn as lines.
+typedef struct
+{
+    Uint32 stamp;
+    Vector2f vertices[MAX_POLYGON_VERTICES];
+} AsteroidTransform;
+
+// Entries run parallel to an asteroid vector and are current while their
+// stamp matches the cache's.  Moving the asteroids bumps the cache's stamp,
+// which dirties every entry at once; removing one dirties the two slots
+// the swap touches.  Stamp 0 is never current.
+typedef struct
+{
+    std::vector<AsteroidTransform> entries;
+    Uint32 stamp = 1;
+    int computed = 0;
+    int avoided = 0;  // Uses served from the cache, or not needed at all.
+} TransformCache;
+
+static const int TEXT_SCALE = 5;
+static const int TEXT_ATLAS_COLUMNS = 16;
+
+// Sprite mode draws every asteroid as a quad from one atlas holding each
+// outline variant at ASTEROID_ROTATIONS evenly spaced angles, so the whole
+// field is a single geometry call.  Frames snap to the nearest angle, at
+// most half a step (2.8 degrees) from the true one.
+static const int ASTEROID_ROTATIONS = 64;
+static const int ASTEROID_ATLAS_WIDTH = 4096;
+
+// One shelf of square frames per asteroid size, variant-major.
+typedef struct
+{
+    int originY;
+    int frameSize; // Widest radius each way plus a clear border pixel.
+    int columns;
+} SpriteShelf;
+
+// Dynamic resolution: the scene is drawn into an offscreen target at
+// gRenderScale of the window size and stretched to fit.  A few frames over
+// budget drop one step right away; climbing back needs a long run of frames
+// comfortably inside budget, and each failed climb makes the next one wait
+// longer, so the scale doesn't oscillate around the limit.
+static const float RENDERSCALE_MIN = 0.5f;
+static const float RENDERSCALE_STEP = 0.125f;
+static const double FRAME_BUDGET_MS = 1000.0 / 60;
+static const double RENDERSCALE_OVER_BUDGET = 1.2;  // x budget, i.e. a missed vsync.
+static const double RENDERSCALE_UNDER_BUDGET = 1.05;
+static const int RENDERSCALE_DROP_FRAMES = 3;
+static const int RENDERSCALE_RAISE_FRAMES = 120;
+static const int RENDERSCALE_MAX_RAISE_FRAMES = 1920;
 
 typedef enum
 {
@@ -110,41 +286,176 @@ typedef enum
 
 static const double MS_PER_UPDATE = 1000 / 60;
 
+// Time control: ']' and '[' step through these multiples of real time and
+// BACKSPACE returns to 1x.  Above 1x the scene is only drawn every
+// FASTFORWARD_FRAME_MS, so nearly all of the CPU goes to ticks.
+static const double TIME_SCALES[] = { 0.125, 0.25, 0.5, 1, 2, 4, 8, 16, 32, 64 };
+static const int N_TIME_SCALES = sizeof(TIME_SCALES) / sizeof(TIME_SCALES[0]);
+static const int TIME_SCALE_NORMAL = 3;
+static const double FASTFORWARD_FRAME_MS = 100;
+// Catch-up ticks still owed after this much wall time in one frame are
+// dropped rather than carried into the next.
+static const double MAX_CATCHUP_MS = 250;
+
+// Ticks before --strict-alloc starts treating allocations as errors.
+static const Uint32 ALLOC_WARMUP_TICKS = 60;
+
+typedef enum
+{
+    InputAction_TurnLeft,
+    InputAction_TurnRight,
+    InputAction_Thrust,
+    InputAction_Shoot,
+    InputAction_Restart,
+    N_INPUT_ACTIONS
+} InputAction;
+
+typedef struct
+{
+    Uint32 timestamp; // SDL event time in milliseconds.
+    Uint64 polled;    // Performance counter when pollInput dequeued it.
+    InputAction action;
+    bool pressed;
+} InputCommand;
+
+static const int INPUT_QUEUE_SIZE = 256;
+
+// Latencies are in microseconds, binned 100 us at a time; the last bucket
+// collects everything slower than 100 ms.
+static const Uint32 LATENCY_BUCKET_US = 100;
+static const int LATENCY_HISTOGRAM_BUCKETS = 1000;
+
+typedef struct
+{
+    Uint32 buckets[LATENCY_HISTOGRAM_BUCKETS];
+    Uint32 count;
+    Uint32 max;
+    double total;
+} LatencyHistogram;
+
 static void init();
 static void quit();
 static Asteroid createAsteroid(AsteroidSize size);
+static void reserveAsteroids(size_t capacity);
+static void sizeSpriteBuffers(size_t nSprites);
+static int asteroidPieces(AsteroidSize size);
 static Ship createShip();
-static Projectile createProjectile(Vector2f position, float angle, float speed);
+static Projectile createProjectile(Vector2f position, Real angle, Real speed);
+static void pollInput();
+static void queueInput(InputCommand command);
+static void applyInput(Uint32 tickTime);
+static void setInput(InputAction action, bool pressed);
+static void setTimeScale(int index);
+static void recordLatency(LatencyHistogram &histogram, Uint32 latency);
+static Uint32 latencyPercentile(const LatencyHistogram &histogram, double percentile);
+static void checkAllocations(const char *scope, const AllocCounts before[N_ALLOC_PHASES]);
 static void update();
-static void updateAsteroids(std::vector<Asteroid> &asteroids);
+static void updateAsteroids(std::vector<Asteroid> &asteroids, TransformCache &transforms);
 static void updateAsteroid(Asteroid &asteroid);
 static void updateShip(Ship &ship);
+static void orientShip(Ship &ship);
 static void updateProjectiles(std::vector<Projectile> &projectiles, int lifeTime);
 static void updateProjectile(Projectile &projectile);
 static void render();
-static void renderAsteroids(std::vector<Asteroid> asteroids);
-static void renderAsteroid(Asteroid asteroid);
+static void renderAsteroids(const std::vector<Asteroid> &asteroids, TransformCache &transforms);
+static void renderAsteroid(const Vector2f *vertices, int nVertices);
+static bool asteroidOnScreen(const Asteroid &asteroid);
+static void renderAsteroidSprites(const std::vector<Asteroid> &asteroids);
 static void renderShip(Ship ship);
-static void renderProjectiles(std::vector<Projectile> projectiles);
-static void renderProjectile(Projectile &projectile);
-static void renderText(const char *text, Vector2f position);
+static void renderProjectiles(const std::vector<Projectile> &projectiles);
+static void renderProjectile(const Projectile &projectile);
+static void renderText(const char *text, SDL_Point position);
+static void updateRenderScale(double frameMs);
+static void publishTelemetry(double tickMs, double frameMs);
+static void randomSeed(Uint32 seed);
+static Uint32 randomNext();
 static int randomDirection();
 static int random(int min, int max);
-static float randomNormal();
+static Real randomNormal();
 static bool linesIntersect(Vector2f origin1, Vector2f origin2, Line l1, Line l2);
 static bool counterClockwise(Vector2f a, Vector2f b, Vector2f c);
-static float distance(Vector2f p1, Vector2f p2);
+static Real distance(Vector2f p1, Vector2f p2);
+static void initPolygonTables();
+static void initAsteroidShapes();
+static int asteroidSizeIndex(AsteroidSize size);
+static int asteroidVertices(const Asteroid &asteroid, Vector2f *vertices);
+static const Vector2f *asteroidWorldVertices(TransformCache &cache,
+                                             const std::vector<Asteroid> &asteroids,
+                                             int index);
+static void invalidateTransforms(TransformCache &cache);
+static void dirtyTransform(TransformCache &cache, int index);
+static bool convexPolygonsOverlap(const Vector2f *a, int nA, const Vector2f *b, int nB);
+static bool shipAsteroidOverlapSAT(const Ship &ship,
+                                   const std::vector<Asteroid> &asteroids,
+                                   int index,
+                                   TransformCache &transforms);
+static bool shipAsteroidOverlapSegments(const Ship &ship, const Asteroid &asteroid);
+static void asteroidEdgeBatch(const Vector2f *vertices, int nVertices, SegmentBatch &batch);
+static void asteroidEdgeBatchInt(const Vector2f *vertices, int nVertices, Vector2f origin,
+                                 SegmentBatchInt &batch);
+static Sint32 edgeGridCoordinate(Real value);
+static void asteroidEdges(const Asteroid &asteroid, const Vector2f *vertices, AsteroidEdges &edges);
+static bool segmentCrossesEdges(Vector2f p1, Vector2f p2, const AsteroidEdges &edges);
+static bool outlineCrossesEdges(const Vector2f *vertices, int nVertices,
+                                const AsteroidEdges &edges);
+static int collideAsteroids(std::vector<Asteroid> &asteroids,
+                            std::vector<SweepEntry> &sweep,
+                            TransformCache &transforms);
+static bool sweepBefore(const SweepEntry &a, const SweepEntry &b);
+static int collideAsteroidPair(std::vector<Asteroid> &asteroids,
+                               TransformCache &transforms,
+                               const SweepEntry &a,
+                               const SweepEntry &b);
+static bool asteroidsOverlap(const std::vector<Asteroid> &asteroids,
+                             TransformCache &transforms,
+                             int a,
+                             int b);
+static bool outlinesCross(const std::vector<Asteroid> &asteroids,
+                          TransformCache &transforms,
+                          int a,
+                          int b);
+static void bounceAsteroids(Asteroid &a, Asteroid &b);
+static void runAsteroidBenchmark();
+static bool writeScenario(const char *path);
+static bool writeScenarioArray(int fd, const void *data, Uint64 size, Uint64 &offset);
+static bool loadScenario(const char *path);
+static bool scenarioArrayFits(Uint64 offset, Uint64 count, Uint64 elementSize,
+                              Uint64 alignment, Uint64 fileSize);
+static bool scenarioAsteroidValid(const Asteroid &asteroid);
+static bool scenarioShipValid(const Ship &ship);
+static bool scenarioProjectileValid(const Projectile &projectile, int lifeTime, Real maxSpeed);
+static bool scenarioRealInRange(Real value, Real min, Real max);
+static bool scenarioAngleValid(Real angle);
+static bool scenarioPositionValid(Vector2f position);
+static bool scenarioVelocityValid(Vector2f velocity, Real maxSpeed);
+static void runScenarioBenchmark(const char *path, int nAsteroids);
+static void runCollisionBenchmark();
+static void runAudioBenchmark();
+static void runSegmentBenchmark();
+static void runSpriteBenchmark();
+static Uint64 hashState();
+static void hashValue(Uint64 &hash, Uint32 value);
+static void hashVector(Uint64 &hash, Vector2f vector);
+static void runHashRun(int nTicks, Uint32 seed, int nAsteroids);
 static void wrapPosition(Vector2f &position, int bufferX, int bufferY);
-static void checkCollisions(Ship ship, std::vector<Asteroid> asteroids);
-static void checkCollision(Ship ship, Asteroid asteroids);
-static void fireProjectileFromPoint(Vector2f point, float angle);
+static void checkCollisions(const Ship &ship,
+                            const std::vector<Asteroid> &asteroids,
+                            TransformCache &transforms);
+static void checkCollision(Ship ship,
+                           const std::vector<Asteroid> &asteroids,
+                           int asteroidIndex,
+                           TransformCache &transforms);
+static void fireProjectileFromPoint(Vector2f point, Real angle);
 static void destroyProjectile(int projectileIndex, std::vector<Projectile> &projectiles);
 static void destroyAsteroid(int asteroidIndex);
 static void splitAsteroid(int asteroidIndex);
-static void checkProjectileCollisions(std::vector<Projectile> projectiles,
-                                      std::vector<Asteroid> asteroids);
+static void checkProjectileCollisions(const std::vector<Projectile> &projectiles,
+                                      const std::vector<Asteroid> &asteroids,
+                                      TransformCache &transforms);
 static void explode(Vector2f position);
-static TTF_Font *loadFont(const char *path);
+static SDL_Texture *createFontAtlas();
+static SDL_Texture *createAsteroidAtlas();
+static void rasterizeLine(Uint32 *pixels, int pitch, int x1, int y1, int x2, int y2);
 static void checkWin();
 
 static bool gRunning = false;
@@ -155,15 +466,151 @@ static std::vector<Asteroid> gAsteroids;
 static Ship gShip;
 static std::vector<Projectile> gProjectiles;
 static std::vector<Projectile> gParticles;
+static std::vector<SweepEntry> gAsteroidSweep;
+static TransformCache gAsteroidTransforms;
+static const char *gScenarioPath = nullptr;
 
-static TTF_Font *gDefaultFont;
+static SDL_Texture *gFontAtlas = nullptr;
+static SDL_Texture *gAsteroidAtlas = nullptr;
+static SpriteShelf gAtlasShelves[N_ASTEROID_SIZES];
+static int gAtlasHeight = 0;
+static bool gAsteroidSprites = false;
+static std::vector<SDL_Vertex> gSpriteVertices;
+static std::vector<int> gSpriteIndices;
 static GameState gState;
 
+static InputCommand gInputQueue[INPUT_QUEUE_SIZE];
+static int gInputHead = 0;
+static int gInputCount = 0;
+static LatencyHistogram gInputLatency;
+
+static Uint32 gTicks = 0;
+static Uint32 gRandomState = 1;
+static bool gStrictAllocations = false;
+static AllocCounts gFrameAllocations[N_ALLOC_PHASES];
+static int gDrawCalls = 0;
+
+static SDL_Texture *gSceneTarget = nullptr;
+static bool gDynamicResolution = true;
+static float gRenderScale = 1.0f;
+static int gOverBudgetFrames = 0;
+static int gUnderBudgetFrames = 0;
+static int gRaiseFrames = RENDERSCALE_RAISE_FRAMES;
+static bool gJustRaised = false;
+
+static int gTimeScaleIndex = TIME_SCALE_NORMAL;
+
+// Unit vectors for each vertex of an n-vertex radial polygon, indexed by
+// [n][vertex], so transforming a shape needs no trig per vertex.
+static Vector2f gPolygonDirections[MAX_POLYGON_VERTICES + 1][MAX_POLYGON_VERTICES];
+static Polygon gAsteroidShapes[N_ASTEROID_SIZES][ASTEROID_VARIANTS];
+
 int main(int argc, const char * argv[])
 {
-    if (SDL_Init(SDL_INIT_EVERYTHING) < 0)
+    Uint64 startCounter = SDL_GetPerformanceCounter();
+    bool firstFrame = true;
+    
+    initPolygonTables();
+    initAsteroidShapes();
+    
+    if (argc > 1 && strcmp(argv[1], "--bench-collision") == 0)
+    {
+        runCollisionBenchmark();
+        return 0;
+    }
+    
+    if (argc > 1 && strcmp(argv[1], "--bench-audio") == 0)
+    {
+        runAudioBenchmark();
+        return 0;
+    }
+    
+    if (argc > 1 && strcmp(argv[1], "--bench-segments") == 0)
+    {
+        runSegmentBenchmark();
+        return 0;
+    }
+    
+    if (argc > 1 && strcmp(argv[1], "--bench-asteroids") == 0)
+    {
+        runAsteroidBenchmark();
+        return 0;
+    }
+    
+    if (argc > 1 && strcmp(argv[1], "--bench-sprites") == 0)
+    {
+        runSpriteBenchmark();
+        return 0;
+    }
+    
+    if (argc > 3 && strcmp(argv[1], "--make-scenario") == 0)
+    {
+        runScenarioBenchmark(argv[2], atoi(argv[3]));
+        return 0;
+    }
+    
+    if (argc > 2 && strcmp(argv[1], "--hash-run") == 0)
+    {
+        runHashRun(atoi(argv[2]),
+                   (argc > 3) ? (Uint32)strtoul(argv[3], nullptr, 10) : 1,
+                   (argc > 4) ? atoi(argv[4]) : N_INIT_ASTEROIDS);
+        return 0;
+    }
+    
+    const char *logPath = nullptr;
+    const char *telemetryName = nullptr;
+    Uint32 seed = (Uint32)time(nullptr);
+    
+    for (int argIndex = 1; argIndex < argc; argIndex++)
+    {
+        if (strcmp(argv[argIndex], "--log") == 0 && argIndex + 1 < argc)
+        {
+            logPath = argv[++argIndex];
+        }
+        else if (strcmp(argv[argIndex], "--verbose") == 0)
+        {
+            logSetLevel(LogLevel_Debug);
+        }
+        else if (strcmp(argv[argIndex], "--strict-alloc") == 0)
+        {
+            gStrictAllocations = true;
+        }
+        else if (strcmp(argv[argIndex], "--audio-driver") == 0 && argIndex + 1 < argc)
+        {
+            SDL_setenv("SDL_AUDIODRIVER", argv[++argIndex], 1);
+        }
+        else if (strcmp(argv[argIndex], "--scenario") == 0 && argIndex + 1 < argc)
+        {
+            gScenarioPath = argv[++argIndex];
+        }
+        else if (strcmp(argv[argIndex], "--seed") == 0 && argIndex + 1 < argc)
+        {
+            seed = (Uint32)strtoul(argv[++argIndex], nullptr, 10);
+        }
+        else if (strcmp(argv[argIndex], "--telemetry") == 0)
+        {
+            telemetryName = TELEMETRY_DEFAULT_NAME;
+            
+            if (argIndex + 1 < argc && argv[argIndex + 1][0] == '/')
+            {
+                telemetryName = argv[++argIndex];
+            }
+        }
+    }
+    
+    logInit(logPath);
+    logMessage(LogLevel_Info, "Random seed %u", seed);
+    randomSeed(seed);
+    
+    if (telemetryName != nullptr)
+    {
+        telemetryInit(telemetryName);
+    }
+    
+    if (SDL_Init(SDL_SUBSYSTEMS) < 0)
     {
-        std::cout << "Unable to init SDL" << std::endl;
+        logMessage(LogLevel_Error, "Unable to init SDL: %s", SDL_GetError());
+        telemetryQuit();
         exit(1);
     }
     
@@ -176,7 +623,8 @@ int main(int argc, const char * argv[])
     
     if (gWindow == nullptr)
     {
-        std::cout << "Unable to create window" << std::endl;
+        logMessage(LogLevel_Error, "Unable to create window: %s", SDL_GetError());
+        telemetryQuit();
         SDL_Quit();
         exit(1);
     }
@@ -185,112 +633,173 @@ int main(int argc, const char * argv[])
     
     if (gRenderer == nullptr)
     {
-        std::cout << "Unable to create renderer" << std::endl;
+        logMessage(LogLevel_Error, "Unable to create renderer: %s", SDL_GetError());
+        telemetryQuit();
         SDL_Quit();
         exit(1);
     }
     
-    if (TTF_Init() == -1)
+    gFontAtlas = createFontAtlas();
+    
+    // Linear filtering so the upscaled scene doesn't look blocky.
+    SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "1");
+    gSceneTarget = SDL_CreateTexture(gRenderer,
+                                     SDL_PIXELFORMAT_ARGB8888,
+                                     SDL_TEXTUREACCESS_TARGET,
+                                     WINDOW_WIDTH,
+                                     WINDOW_HEIGHT);
+    
+    if (gSceneTarget == nullptr)
     {
-        std::cout << "Unable to init SDL_ttf" << std::endl;
-        quit();
-        exit(1);
+        logMessage(LogLevel_Warning, "No render target, dynamic resolution disabled: %s",
+                   SDL_GetError());
     }
     
+    // After the hint, so sprites filter smoothly at reduced render scales.
+    gAsteroidAtlas = createAsteroidAtlas();
+    hudInit(gRenderer, gFontAtlas, TEXT_ATLAS_COLUMNS);
+    audioInit();
+    
+    reserveAsteroids(ASTEROID_CAPACITY);
+    gProjectiles.reserve(PROJECTILE_CAPACITY);
+    gParticles.reserve(PARTICLE_CAPACITY);
+    
     init();
     
-    gDefaultFont = loadFont("Resources/Fonts/alterebro-pixel-font.ttf");
     gRunning = true;
-    SDL_Event event;
     
+    // lag and simulationTime are wall-clock milliseconds; at a time scale
+    // of s each tick stands for MS_PER_UPDATE / s of them.
     double previous = (double)SDL_GetTicks();
     double lag = 0.0;
+    double simulationTime = previous;
+    double lastRender = previous;
+    Uint64 frameStartCounter = SDL_GetPerformanceCounter();
+    double lastFrameMs = 0.0;
     
     while (gRunning)
     {
-        while (SDL_PollEvent(&event))
-        {
-            switch (event.type)
-            {
-                case SDL_QUIT:
-                    gRunning = false;
-                    break;
-                    
-                case SDL_KEYDOWN:
-                    switch (event.key.keysym.sym)
-                    {
-                        case SDLK_LEFT:
-                            gShip.turnLeft = true;
-                            break;
-                            
-                        case SDLK_RIGHT:
-                            gShip.turnRight = true;
-                            break;
-                            
-                        case SDLK_UP:
-                            gShip.thrusting = true;
-                            break;
-                            
-                        case SDLK_SPACE:
-                            gShip.shooting = true;
-                            break;
-                            
-                        case SDLK_RETURN:
-                            if (gState == GameState_Lost ||
-                                gState == GameState_Won)
-                            {
-                                gAsteroids.clear();
-                                gParticles.clear();
-                                gProjectiles.clear();
-                                init();
-                            }
-                            break;
-                            
-                        default:
-                            break;
-                    }
-                    break;
-                    
-                case SDL_KEYUP:
-                    switch (event.key.keysym.sym)
-                    {
-                        case SDLK_LEFT:
-                            gShip.turnLeft = false;
-                            break;
-                            
-                        case SDLK_RIGHT:
-                                gShip.turnRight = false;
-                            break;
-                            
-                        case SDLK_UP:
-                            gShip.thrusting = false;
-                            break;
-                                
-                        case SDLK_SPACE:
-                            gShip.shooting = false;
-                            
-                        default:
-                            break;
-                    }
-                    break;
-                    
-                default:
-                    break;
-            }
-        }
+        AllocCounts frameStart[N_ALLOC_PHASES];
+        allocGetCounts(frameStart);
+        
+        allocSetPhase(AllocPhase_Input);
+        hudPhaseBegin(HudPhase_Input);
+        pollInput();
+        hudPhaseEnd(HudPhase_Input);
         
         double current = (double)SDL_GetTicks();
         double elapsed = current - previous;
         lag += elapsed;
         previous = current;
         
-        while (lag >= MS_PER_UPDATE)
+        double tickInterval = MS_PER_UPDATE / TIME_SCALES[gTimeScaleIndex];
+        bool fastForward = TIME_SCALES[gTimeScaleIndex] > 1.0;
+        // Fast-forward ticks until the next render is due; otherwise
+        // catching up may take at most MAX_CATCHUP_MS.
+        double tickDeadline = fastForward ? lastRender + FASTFORWARD_FRAME_MS :
+                                            current + MAX_CATCHUP_MS;
+        int ticksRun = 0;
+        
+        while (lag >= tickInterval)
         {
+            // Each tick consumes exactly the input that happened before its
+            // boundary; polling again here keeps catch-up ticks from using
+            // a frame-old view of the keyboard.
+            AllocCounts tickStart[N_ALLOC_PHASES];
+            allocGetCounts(tickStart);
+            
+            Uint64 tickStartCounter = SDL_GetPerformanceCounter();
+            
+            simulationTime += tickInterval;
+            allocSetPhase(AllocPhase_Input);
+            hudPhaseBegin(HudPhase_Input);
+            pollInput();
+            applyInput((Uint32)simulationTime);
+            hudPhaseEnd(HudPhase_Input);
+            allocSetPhase(AllocPhase_Update);
             update();
-            lag -= MS_PER_UPDATE;
+            lag -= tickInterval;
+            ticksRun++;
+            
+            double tickMs = (SDL_GetPerformanceCounter() - tickStartCounter) * 1000.0 /
+                            SDL_GetPerformanceFrequency();
+            hudTick(tickMs);
+            publishTelemetry(tickMs, lastFrameMs);
+            checkAllocations("tick", tickStart);
+            
+            // Out of time with ticks still owed.  Carrying them over would
+            // start the next frame further behind, and the one after that
+            // further still; dropping them just runs slower than asked.
+            if (lag >= tickInterval && SDL_GetTicks() >= tickDeadline)
+            {
+                simulationTime += lag;
+                lag = 0.0;
+                break;
+            }
+        }
+        
+        if (fastForward && SDL_GetTicks() - lastRender < FASTFORWARD_FRAME_MS)
+        {
+            checkAllocations("frame", frameStart);
+            
+            // Nothing was due; don't spin on the event queue.
+            if (ticksRun == 0)
+            {
+                SDL_Delay(1);
+            }
+            
+            continue;
         }
         
+        lastRender = (double)SDL_GetTicks();
+        allocSetPhase(AllocPhase_Render);
         render();
+        allocSetPhase(AllocPhase_Other);
+        
+        checkAllocations("frame", frameStart);
+        
+        Uint64 frameEndCounter = SDL_GetPerformanceCounter();
+        HudFrameStats frameStats;
+        frameStats.asteroids = (int)gAsteroids.size();
+        frameStats.projectiles = (int)gProjectiles.size();
+        frameStats.particles = (int)gParticles.size();
+        frameStats.drawCalls = gDrawCalls;
+        frameStats.allocations = 0;
+        frameStats.inputLatencyP95Us = latencyPercentile(gInputLatency, 0.95);
+        
+        for (int phase = 0; phase < N_ALLOC_PHASES; phase++)
+        {
+            frameStats.allocations += gFrameAllocations[phase].count;
+        }
+        
+        double frameMs = (frameEndCounter - frameStartCounter) * 1000.0 /
+                         SDL_GetPerformanceFrequency();
+        frameStats.renderScale = gRenderScale;
+        frameStats.timeScale = (float)TIME_SCALES[gTimeScaleIndex];
+        frameStats.transforms = gAsteroidTransforms.computed;
+        frameStats.transformsAvoided = gAsteroidTransforms.avoided;
+        gAsteroidTransforms.computed = 0;
+        gAsteroidTransforms.avoided = 0;
+        
+        hudFrame(frameMs, frameStats);
+        
+        // Fast-forward frames span a whole render interval of ticks, which
+        // says nothing about what the renderer can afford.
+        if (!fastForward)
+        {
+            updateRenderScale(frameMs);
+        }
+        
+        frameStartCounter = frameEndCounter;
+        lastFrameMs = frameMs;
+        
+        if (firstFrame)
+        {
+            double startupMs = (SDL_GetPerformanceCounter() - startCounter) * 1000.0 /
+                               SDL_GetPerformanceFrequency();
+            logMessage(LogLevel_Info, "Time to first frame: %.2f ms", startupMs);
+            firstFrame = false;
+        }
     }
     
     quit();
@@ -300,8 +809,15 @@ int main(int argc, const char * argv[])
 
 static void init()
 {
-    srand((int)time(nullptr));
     gState = GameState_Game;
+    // A restart or a loaded file refills the same slots.
+    invalidateTransforms(gAsteroidTransforms);
+    
+    // Restarting a loaded scenario goes back to the file, not a random field.
+    if (gScenarioPath != nullptr && loadScenario(gScenarioPath))
+    {
+        return;
+    }
     
     for (int asteroidIndex = 0;
          asteroidIndex < N_INIT_ASTEROIDS;
@@ -315,21 +831,96 @@ static void init()
 
 static void quit()
 {
+    telemetryQuit();
+    SDL_DestroyTexture(gSceneTarget);
+    gSceneTarget = nullptr;
+    
+    if (gInputLatency.count > 0)
+    {
+        logMessage(LogLevel_Info,
+                   "Input latency: %u events, p50 %.1f ms, p95 %.1f ms, p99 %.1f ms, max %.1f ms",
+                   gInputLatency.count,
+                   latencyPercentile(gInputLatency, 0.50) / 1000.0,
+                   latencyPercentile(gInputLatency, 0.95) / 1000.0,
+                   latencyPercentile(gInputLatency, 0.99) / 1000.0,
+                   gInputLatency.max / 1000.0);
+    }
+    
+    audioQuit();
+    
+    SDL_DestroyTexture(gAsteroidAtlas);
+    SDL_DestroyTexture(gFontAtlas);
     SDL_DestroyRenderer(gRenderer);
     SDL_DestroyWindow(gWindow);
     
+    gAsteroidAtlas = nullptr;
+    gFontAtlas = nullptr;
     gRenderer = nullptr;
     gWindow = nullptr;
     
     SDL_Quit();
 }
 
+// Grows every buffer indexed by asteroid to hold capacity of them, so a
+// field that size never reallocates mid-tick.
+static void reserveAsteroids(size_t capacity)
+{
+    gAsteroids.reserve(capacity);
+    gAsteroidSweep.reserve(capacity);
+    gAsteroidTransforms.entries.reserve(capacity);
+    sizeSpriteBuffers(capacity);
+}
+
+// Grows the sprite buffers to nSprites quads.  Every quad uses the same
+// index pattern, so indices are written here once rather than per frame.
+static void sizeSpriteBuffers(size_t nSprites)
+{
+    size_t first = gSpriteIndices.size() / 6;
+    
+    if (nSprites <= first)
+    {
+        return;
+    }
+    
+    gSpriteVertices.resize(nSprites * 4);
+    gSpriteIndices.resize(nSprites * 6);
+    
+    for (size_t sprite = first; sprite < nSprites; sprite++)
+    {
+        int vertex = (int)sprite * 4;
+        int *quad = &gSpriteIndices[sprite * 6];
+        
+        quad[0] = vertex;
+        quad[1] = vertex + 1;
+        quad[2] = vertex + 2;
+        quad[3] = vertex;
+        quad[4] = vertex + 2;
+        quad[5] = vertex + 3;
+    }
+}
+
+// Most asteroids one of this size can turn into by being split.
+static int asteroidPieces(AsteroidSize size)
+{
+    switch (size)
+    {
+        case ASTEROIDSIZE_LARGE:
+            return 4;
+            
+        case ASTEROIDSIZE_MEDIUM:
+            return 2;
+            
+        default:
+            return 1;
+    }
+}
+
 static Asteroid createAsteroid(AsteroidSize size)
 {
     Asteroid asteroid;
     asteroid.size = size;
-    asteroid.angle = 0.0f;
-    asteroid.angularVelocity = 0.02 * randomDirection();
+    asteroid.angle = realFromInt(0);
+    asteroid.angularVelocity = ASTEROID_ANGULARSPEED * randomDirection();
     int maxVel = 0;
     
     switch (size)
@@ -351,36 +942,20 @@ static Asteroid createAsteroid(AsteroidSize size)
     }
     
     asteroid.velocity.x = maxVel * randomNormal();
-    asteroid.velocity.y = sqrtf(powf(maxVel, 2.0f) -
-                                powf(asteroid.velocity.x, 2.0f));
+    asteroid.velocity.y = realSqrt(realFromInt(maxVel * maxVel) -
+                                   asteroid.velocity.x * asteroid.velocity.x);
     
     asteroid.velocity.x *= randomDirection();
     asteroid.velocity.y *= randomDirection();
     
-    Polygon pentagon;
-    // The distance each vertex is from center is equal to its size id.
-    int r = size;
-    float theta = (2 * M_PI) / N_LINES;
-    
-    for (int i = 0; i < N_LINES; i++)
-    {
-        pentagon.lines[i] = {
-            {
-                (r * cosf(theta * (i - 1) + asteroid.angle)),
-                (r * sinf(theta * (i - 1) + asteroid.angle))
-            },
-            {
-                (r * cosf(theta * i)),
-                (r * sinf(theta * i))
-            }
-        };
-    }
-    
-    asteroid.shape = pentagon;
+    // The rock is drawn, sprite or lines, and collides as the same stock
+    // outline.
+    asteroid.variant = (Uint8)random(0, ASTEROID_VARIANTS - 1);
+    asteroid.shape = gAsteroidShapes[asteroidSizeIndex(size)][asteroid.variant];
     
     asteroid.position = {
-        (float)random(0, WINDOW_WIDTH),
-        (float)random(0, WINDOW_HEIGHT)
+        realFromInt(random(0, WINDOW_WIDTH)),
+        realFromInt(random(0, WINDOW_HEIGHT))
     };
     
     return asteroid;
@@ -394,107 +969,426 @@ static Ship createShip()
     ship.turnLeft = false;
     ship.turnRight = false;
     ship.thrusting = false;
-    ship.speed = 0.0f;
-    ship.thrust = 0.5f;
-    ship.angle = 0.0f;
+    ship.speed = realFromInt(0);
+    ship.thrust = realFromFloat(0.5f);
+    ship.angle = realFromInt(0);
     ship.position = {
-        WINDOW_WIDTH / 2,
-        WINDOW_HEIGHT / 2
+        realFromInt(WINDOW_WIDTH / 2),
+        realFromInt(WINDOW_HEIGHT / 2)
     };
     
-    ship.velocity = { 0.0f, 0.0f };
-    
-    ship.lines[0] = {
-        { 10.0f, 00.0f },
-        { -8.0f, -5.0f }
-    };
-    ship.lines[1] = {
-        { -8.0f, -5.0f },
-        { -8.0f, 5.0f }
-    };
-    ship.lines[2] = {
-        { -8.0f, 5.0f },
-        { 10.0f, 0.0f }
-    };
+    ship.velocity = { realFromInt(0), realFromInt(0) };
+    orientShip(ship);
     
     return ship;
 }
 
-static Projectile createProjectile(Vector2f position, float angle, float speed)
+static Projectile createProjectile(Vector2f position, Real angle, Real speed)
 {
     Projectile projectile;
     
     projectile.lifeCounter = 0;
     projectile.position = position;
     projectile.velocity = {
-        cosf(angle) * speed,
-        sinf(angle) * speed
+        realCos(angle) * speed,
+        realSin(angle) * speed
     };
     
     return projectile;
 }
 
-static void update()
+static void pollInput()
 {
-    updateProjectiles(gProjectiles, PROJECTILE_LIFETIME);
-    updateProjectiles(gParticles, 0.5 * 1000);
-    updateAsteroids(gAsteroids);
+    SDL_Event event;
+    Uint64 polled = SDL_GetPerformanceCounter();
     
-    switch (gState)
+    while (SDL_PollEvent(&event))
     {
-        case GameState_Game:
-            updateShip(gShip);
-            checkCollisions(gShip, gAsteroids);
-            checkWin();
-            break;
-        case GameState_Lost:
-            break;
-        case GameState_Won:
-            updateShip(gShip);
-            break;
-            
-        default:
-            break;
+        if (event.type == SDL_QUIT)
+        {
+            gRunning = false;
+            continue;
+        }
+        
+        if ((event.type != SDL_KEYDOWN && event.type != SDL_KEYUP) ||
+            event.key.repeat)
+        {
+            continue;
+        }
+        
+        // Overlay toggles are UI only and bypass the simulation queue.
+        if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F1)
+        {
+            hudToggle();
+            continue;
+        }
+        
+        if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F2)
+        {
+            gDynamicResolution = !gDynamicResolution;
+            gRenderScale = 1.0f;
+            logMessage(LogLevel_Info, "Dynamic resolution %s",
+                       gDynamicResolution ? "on" : "off");
+            continue;
+        }
+        
+        if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F3)
+        {
+            gAsteroidSprites = !gAsteroidSprites && gAsteroidAtlas != nullptr;
+            logMessage(LogLevel_Info, "Asteroid sprites %s",
+                       gAsteroidSprites ? "on" : "off");
+            continue;
+        }
+        
+        if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_RIGHTBRACKET)
+        {
+            setTimeScale(gTimeScaleIndex + 1);
+            continue;
+        }
+        
+        if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_LEFTBRACKET)
+        {
+            setTimeScale(gTimeScaleIndex - 1);
+            continue;
+        }
+        
+        if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_BACKSPACE)
+        {
+            setTimeScale(TIME_SCALE_NORMAL);
+            continue;
+        }
+        
+        if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F5)
+        {
+            char path[32];
+            snprintf(path, sizeof(path), "scenario-%u.bin", gTicks);
+            writeScenario(path);
+            continue;
+        }
+        
+        InputCommand command;
+        command.timestamp = event.key.timestamp;
+        command.polled = polled;
+        command.pressed = (event.type == SDL_KEYDOWN);
+        
+        switch (event.key.keysym.sym)
+        {
+            case SDLK_LEFT:
+                command.action = InputAction_TurnLeft;
+                break;
+                
+            case SDLK_RIGHT:
+                command.action = InputAction_TurnRight;
+                break;
+                
+            case SDLK_UP:
+                command.action = InputAction_Thrust;
+                break;
+                
+            case SDLK_SPACE:
+                command.action = InputAction_Shoot;
+                break;
+                
+            case SDLK_RETURN:
+                command.action = InputAction_Restart;
+                break;
+                
+            default:
+                continue;
+        }
+        
+        queueInput(command);
     }
-    
-    checkProjectileCollisions(gProjectiles, gAsteroids);
 }
 
-static void updateAsteroids(std::vector<Asteroid> &asteroids)
+static void queueInput(InputCommand command)
 {
-    for (int asteroidIndex = 0;
-         asteroidIndex < asteroids.size();
-         asteroidIndex++)
+    if (gInputCount == INPUT_QUEUE_SIZE)
     {
-        updateAsteroid(asteroids[asteroidIndex]);
+        logMessage(LogLevel_Warning, "Input queue full, dropping event");
+        return;
     }
+    
+    gInputQueue[(gInputHead + gInputCount) % INPUT_QUEUE_SIZE] = command;
+    gInputCount++;
 }
 
-static void updateAsteroid(Asteroid &asteroid)
+// Applies queued commands stamped at or before tickTime.  A release whose
+// press was applied in this same call is held back a tick, so a tap that
+// lands between two ticks still acts for one tick instead of vanishing.
+// Only that key's later commands wait with it; other keys keep draining.
+//
+// Latency runs from when pollInput saw the command to when it is applied,
+// on the performance counter.  It is only recorded at normal speed, since
+// slow motion stretches the wait for the next tick by the time scale.
+static void applyInput(Uint32 tickTime)
 {
-    asteroid.position.x += asteroid.velocity.x;
-    asteroid.position.y += asteroid.velocity.y;
-    asteroid.angle += asteroid.angularVelocity;
-    
-    wrapPosition(asteroid.position, WRAPBUFFER_X, WRAPBUFFER_Y);
-    
-    float r = distance({ 0, 0 },
-                       asteroid.shape.lines[0].p1);
-    float theta = (2 * M_PI) / N_LINES;
-    
-    for (int i = 0; i < N_LINES; i++)
+    bool pressedThisTick[N_INPUT_ACTIONS] = {};
+    bool deferred[N_INPUT_ACTIONS] = {};
+    Uint64 now = SDL_GetPerformanceCounter();
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+    int kept = 0;
+    int scanned = 0;
+    
+    for (; scanned < gInputCount; scanned++)
     {
-        asteroid.shape.lines[i] = {
-            {
-                (r * cosf(theta * (i - 1) + asteroid.angle)),
-                (r * sinf(theta * (i - 1) + asteroid.angle))
-            },
+        InputCommand command = gInputQueue[(gInputHead + scanned) % INPUT_QUEUE_SIZE];
+        
+        if ((Sint32)(command.timestamp - tickTime) > 0)
+        {
+            break;
+        }
+        
+        if (deferred[command.action] ||
+            (!command.pressed && pressedThisTick[command.action]))
+        {
+            // Held commands are packed at the front in their original order.
+            deferred[command.action] = true;
+            gInputQueue[(gInputHead + kept) % INPUT_QUEUE_SIZE] = command;
+            kept++;
+            continue;
+        }
+        
+        if (command.pressed)
+        {
+            pressedThisTick[command.action] = true;
+        }
+        
+        setInput(command.action, command.pressed);
+        
+        if (gTimeScaleIndex == TIME_SCALE_NORMAL)
+        {
+            recordLatency(gInputLatency,
+                          (Uint32)((now - command.polled) * 1000000 / frequency));
+        }
+    }
+    
+    // Slide the held commands up against the unscanned ones and drop the
+    // applied slots in front of them.
+    int applied = scanned - kept;
+    
+    for (int i = kept - 1; i >= 0 && applied > 0; i--)
+    {
+        gInputQueue[(gInputHead + applied + i) % INPUT_QUEUE_SIZE] =
+            gInputQueue[(gInputHead + i) % INPUT_QUEUE_SIZE];
+    }
+    
+    gInputHead = (gInputHead + applied) % INPUT_QUEUE_SIZE;
+    gInputCount -= applied;
+}
+
+static void setInput(InputAction action, bool pressed)
+{
+    switch (action)
+    {
+        case InputAction_TurnLeft:
+            gShip.turnLeft = pressed;
+            break;
+            
+        case InputAction_TurnRight:
+            gShip.turnRight = pressed;
+            break;
+            
+        case InputAction_Thrust:
+            gShip.thrusting = pressed;
+            break;
+            
+        case InputAction_Shoot:
+            gShip.shooting = pressed;
+            break;
+            
+        case InputAction_Restart:
+            if (pressed &&
+                (gState == GameState_Lost || gState == GameState_Won))
             {
-                (r * cosf(theta * i + asteroid.angle)),
-                (r * sinf(theta * i + asteroid.angle))
+                gAsteroids.clear();
+                gParticles.clear();
+                gProjectiles.clear();
+                init();
             }
-        };
+            break;
+            
+        default:
+            break;
+    }
+}
+
+static void setTimeScale(int index)
+{
+    index = std::max(0, std::min(index, N_TIME_SCALES - 1));
+    
+    if (index == gTimeScaleIndex)
+    {
+        return;
+    }
+    
+    gTimeScaleIndex = index;
+    logMessage(LogLevel_Info, "Time scale %gx", TIME_SCALES[index]);
+}
+
+static void recordLatency(LatencyHistogram &histogram, Uint32 latency)
+{
+    Uint32 bucket = std::min(latency / LATENCY_BUCKET_US,
+                             (Uint32)LATENCY_HISTOGRAM_BUCKETS - 1);
+    
+    histogram.buckets[bucket]++;
+    histogram.count++;
+    histogram.total += latency;
+    
+    if (latency > histogram.max)
+    {
+        histogram.max = latency;
+    }
+}
+
+static Uint32 latencyPercentile(const LatencyHistogram &histogram, double percentile)
+{
+    Uint32 target = (Uint32)ceil(histogram.count * percentile);
+    Uint32 seen = 0;
+    
+    for (int bucket = 0; bucket < LATENCY_HISTOGRAM_BUCKETS; bucket++)
+    {
+        seen += histogram.buckets[bucket];
+        
+        if (seen >= target && seen > 0)
+        {
+            // Upper edge of the bucket, so the figure never flatters.
+            return std::min((Uint32)(bucket + 1) * LATENCY_BUCKET_US, histogram.max);
+        }
+    }
+    
+    return histogram.max;
+}
+
+// Records the allocations made since before[] and, in --strict-alloc mode,
+// aborts if steady-state play allocated at all.
+static void checkAllocations(const char *scope, const AllocCounts before[N_ALLOC_PHASES])
+{
+    AllocCounts after[N_ALLOC_PHASES];
+    AllocCounts counts[N_ALLOC_PHASES];
+    allocGetCounts(after);
+    Uint64 total = allocDifference(before, after, counts);
+    
+    if (strcmp(scope, "frame") == 0)
+    {
+        memcpy(gFrameAllocations, counts, sizeof(counts));
+    }
+    
+    if (total == 0)
+    {
+        return;
+    }
+    
+    static LogRateLimit allocationLimit = LOG_RATE_LIMIT(1000);
+    bool fatal = gStrictAllocations && gTicks > ALLOC_WARMUP_TICKS;
+    
+    for (int phase = 0; phase < N_ALLOC_PHASES; phase++)
+    {
+        if (counts[phase].count == 0)
+        {
+            continue;
+        }
+        
+        if (fatal)
+        {
+            logMessage(LogLevel_Error, "Steady-state allocation in %s %s: %llu allocations, %llu bytes",
+                       scope, ALLOC_PHASE_NAMES[phase],
+                       (unsigned long long)counts[phase].count,
+                       (unsigned long long)counts[phase].bytes);
+        }
+        else
+        {
+            logLimited(allocationLimit, LogLevel_Debug, "Allocations in %s %s: %llu, %llu bytes",
+                       scope, ALLOC_PHASE_NAMES[phase],
+                       (unsigned long long)counts[phase].count,
+                       (unsigned long long)counts[phase].bytes);
+        }
+    }
+    
+    if (fatal)
+    {
+        telemetryQuit();
+        logQuit();
+        abort();
+    }
+}
+
+static void update()
+{
+    gTicks++;
+    
+    audioSetLoop(Sound_Thrust, gState != GameState_Lost && gShip.thrusting);
+    
+    hudPhaseBegin(HudPhase_Projectiles);
+    updateProjectiles(gProjectiles, PROJECTILE_LIFETIME);
+    updateProjectiles(gParticles, PARTICLE_LIFETIME);
+    hudPhaseEnd(HudPhase_Projectiles);
+    
+    hudPhaseBegin(HudPhase_Asteroids);
+    updateAsteroids(gAsteroids, gAsteroidTransforms);
+    collideAsteroids(gAsteroids, gAsteroidSweep, gAsteroidTransforms);
+    hudPhaseEnd(HudPhase_Asteroids);
+    
+    switch (gState)
+    {
+        case GameState_Game:
+            hudPhaseBegin(HudPhase_Ship);
+            updateShip(gShip);
+            hudPhaseEnd(HudPhase_Ship);
+            hudPhaseBegin(HudPhase_Collisions);
+            checkCollisions(gShip, gAsteroids, gAsteroidTransforms);
+            hudPhaseEnd(HudPhase_Collisions);
+            checkWin();
+            break;
+        case GameState_Lost:
+            break;
+        case GameState_Won:
+            hudPhaseBegin(HudPhase_Ship);
+            updateShip(gShip);
+            hudPhaseEnd(HudPhase_Ship);
+            break;
+            
+        default:
+            break;
+    }
+    
+    hudPhaseBegin(HudPhase_Collisions);
+    checkProjectileCollisions(gProjectiles, gAsteroids, gAsteroidTransforms);
+    hudPhaseEnd(HudPhase_Collisions);
+}
+
+static void updateAsteroids(std::vector<Asteroid> &asteroids, TransformCache &transforms)
+{
+    for (int asteroidIndex = 0;
+         asteroidIndex < asteroids.size();
+         asteroidIndex++)
+    {
+        updateAsteroid(asteroids[asteroidIndex]);
+    }
+    
+    // Nothing is transformed here; whatever the tick turns out to need is
+    // transformed when it's first asked for.
+    invalidateTransforms(transforms);
+}
+
+static void updateAsteroid(Asteroid &asteroid)
+{
+    asteroid.position.x += asteroid.velocity.x;
+    asteroid.position.y += asteroid.velocity.y;
+    asteroid.angle += asteroid.angularVelocity;
+    
+    // Kept within one turn so a long run can't overflow a fixed-point
+    // angle or wear away a float one's precision.
+    if (asteroid.angle >= REAL_TWO_PI)
+    {
+        asteroid.angle -= REAL_TWO_PI;
+    }
+    else if (asteroid.angle < realFromInt(0))
+    {
+        asteroid.angle += REAL_TWO_PI;
     }
+    
+    wrapPosition(asteroid.position, WRAPBUFFER_X, WRAPBUFFER_Y);
 }
 
 static void updateShip(Ship &ship)
@@ -504,7 +1398,7 @@ static void updateShip(Ship &ship)
     
     wrapPosition(ship.position, WRAPBUFFER_X, WRAPBUFFER_Y);
     
-    float angle = 0.0f;
+    Real angle = realFromInt(0);
     
     if (ship.turnLeft)
     {
@@ -529,32 +1423,41 @@ static void updateShip(Ship &ship)
         }
         
         ship.velocity = {
-            cosf(ship.angle) * ship.speed,
-            sinf(ship.angle) * ship.speed
+            realCos(ship.angle) * ship.speed,
+            realSin(ship.angle) * ship.speed
         };
     }
     else
     {
         ship.velocity = {
-            ship.velocity.x * 0.99f,
-            ship.velocity.y * 0.99f
+            ship.velocity.x * SHIP_DRAG,
+            ship.velocity.y * SHIP_DRAG
         };
         
-        ship.speed *= 0.9f;
+        ship.speed *= SHIP_SPEED_DECAY;
         
-        if (fabs(ship.velocity.x) < 0.005f)
+        if (realAbs(ship.velocity.x) < SHIP_REST_SPEED)
         {
-            ship.velocity.x = 0;
+            ship.velocity.x = realFromInt(0);
         }
         
-        if (fabs(ship.velocity.y) < 0.005f)
+        if (realAbs(ship.velocity.y) < SHIP_REST_SPEED)
         {
-            ship.velocity.y = 0;
+            ship.velocity.y = realFromInt(0);
         }
     }
     
     ship.angle += angle;
     
+    if (ship.angle >= REAL_TWO_PI)
+    {
+        ship.angle -= REAL_TWO_PI;
+    }
+    else if (ship.angle < realFromInt(0))
+    {
+        ship.angle += REAL_TWO_PI;
+    }
+    
     if (ship.shooting)
     {
         if (ship.cooldown == 0)
@@ -575,21 +1478,32 @@ static void updateShip(Ship &ship)
         ship.cooldown = 0;
     }
     
+    orientShip(ship);
+}
+
+// One absolute rotation of SHIP_OUTLINE.  Turning the previous tick's
+// lines instead compounded the trig tables' rounding, and in the
+// fixed-point build grew the ship every tick it turned.
+static void orientShip(Ship &ship)
+{
+    Real c = realCos(ship.angle);
+    Real s = realSin(ship.angle);
+    
     for (int i = 0;
          i < N_SHIP_LINES;
          i++)
     {
-        Vector2f p1 = ship.lines[i].p1;
-        Vector2f p2 = ship.lines[i].p2;
+        Vector2f p1 = SHIP_OUTLINE[i].p1;
+        Vector2f p2 = SHIP_OUTLINE[i].p2;
         
         ship.lines[i] = {
             {
-                p1.x * cosf(angle) - p1.y * sinf(angle),
-                p1.x * sinf(angle) + p1.y * cosf(angle)
+                p1.x * c - p1.y * s,
+                p1.x * s + p1.y * c
             },
             {
-                p2.x * cosf(angle) - p2.y * sinf(angle),
-                p2.x * sinf(angle) + p2.y * cosf(angle)
+                p2.x * c - p2.y * s,
+                p2.x * s + p2.y * c
             }
         };
     }
@@ -623,12 +1537,29 @@ static void updateProjectile(Projectile &projectile)
 
 static void render()
 {
+    hudPhaseBegin(HudPhase_Render);
+    gDrawCalls = 0;
+    
+    if (gSceneTarget != nullptr)
+    {
+        SDL_SetRenderTarget(gRenderer, gSceneTarget);
+        SDL_RenderSetScale(gRenderer, gRenderScale, gRenderScale);
+    }
+    
     SDL_SetRenderDrawColor(gRenderer, 0, 0, 0, 255);
     SDL_RenderClear(gRenderer);
     
     renderProjectiles(gProjectiles);
     renderProjectiles(gParticles);
-    renderAsteroids(gAsteroids);
+    
+    if (gAsteroidSprites)
+    {
+        renderAsteroidSprites(gAsteroids);
+    }
+    else
+    {
+        renderAsteroids(gAsteroids, gAsteroidTransforms);
+    }
     
     switch (gState)
     {
@@ -649,35 +1580,121 @@ static void render()
             break;
     }
     
+    if (gSceneTarget != nullptr)
+    {
+        // Only the top-left gRenderScale portion of the target was drawn.
+        SDL_Rect scene = {
+            0,
+            0,
+            (int)(WINDOW_WIDTH * gRenderScale),
+            (int)(WINDOW_HEIGHT * gRenderScale)
+        };
+        
+        SDL_SetRenderTarget(gRenderer, nullptr);
+        SDL_RenderSetScale(gRenderer, 1.0f, 1.0f);
+        SDL_RenderCopy(gRenderer, gSceneTarget, &scene, nullptr);
+        gDrawCalls++;
+    }
+    
+    hudPhaseEnd(HudPhase_Render);
+    
+    hudRender();
+    
+    hudPhaseBegin(HudPhase_Present);
     SDL_RenderPresent(gRenderer);
+    hudPhaseEnd(HudPhase_Present);
 }
 
-static void renderAsteroids(std::vector<Asteroid> asteroids)
+static void renderAsteroids(const std::vector<Asteroid> &asteroids, TransformCache &transforms)
 {
     for (int asteroidIndex = 0;
          asteroidIndex < asteroids.size();
          asteroidIndex++)
     {
-        renderAsteroid(asteroids[asteroidIndex]);
+        const Asteroid &asteroid = asteroids[asteroidIndex];
+        
+        // Rocks in the wrap buffer can be wholly out of sight.
+        if (!asteroidOnScreen(asteroid))
+        {
+            transforms.avoided++;
+            continue;
+        }
+        
+        renderAsteroid(asteroidWorldVertices(transforms, asteroids, asteroidIndex),
+                       asteroid.shape.nVertices);
     }
 }
 
-static void renderAsteroid(Asteroid asteroid)
+static void renderAsteroid(const Vector2f *vertices, int nVertices)
 {
+    SDL_Point points[MAX_POLYGON_VERTICES + 1];
+    
+    for (int i = 0; i < nVertices; i++)
+    {
+        points[i] = { realToInt(vertices[i].x), realToInt(vertices[i].y) };
+    }
+    
+    points[nVertices] = points[0];
+    
     SDL_SetRenderDrawColor(gRenderer, 255, 255, 255, 255);
+    SDL_RenderDrawLines(gRenderer, points, nVertices + 1);
+    gDrawCalls++;
+}
+
+// False only when no pixel of the outline can land in the window.  Points
+// are truncated toward zero, so anything above -1 still draws on the edge.
+static bool asteroidOnScreen(const Asteroid &asteroid)
+{
+    Real radius = asteroid.size * ASTEROID_RADIUS_MAX;
     
-    for (int lineIndex = 0;
-         lineIndex < N_LINES;
-         lineIndex++)
+    return asteroid.position.x + radius > realFromInt(-1) &&
+           asteroid.position.y + radius > realFromInt(-1) &&
+           asteroid.position.x - radius < realFromInt(WINDOW_WIDTH) &&
+           asteroid.position.y - radius < realFromInt(WINDOW_HEIGHT);
+}
+
+// Every asteroid as a quad from the atlas, centered where renderAsteroid
+// would put it, in one geometry call.  The buffers are sized by
+// reserveAsteroids; past that, the extra rocks are not drawn rather than
+// allocating mid-frame.
+static void renderAsteroidSprites(const std::vector<Asteroid> &asteroids)
+{
+    int nSprites = (int)std::min(asteroids.size(), gSpriteVertices.size() / 4);
+    float atlasWidth = (float)ASTEROID_ATLAS_WIDTH;
+    float atlasHeight = (float)gAtlasHeight;
+    float rotationsPerRadian = ASTEROID_ROTATIONS / realToFloat(REAL_TWO_PI);
+    SDL_Color color = { 255, 255, 255, 255 };
+    
+    for (int i = 0; i < nSprites; i++)
     {
-        Line current = asteroid.shape.lines[lineIndex];
+        const Asteroid &asteroid = asteroids[i];
+        const SpriteShelf &shelf = gAtlasShelves[asteroidSizeIndex(asteroid.size)];
+        int rotation = (int)(realToFloat(asteroid.angle) * rotationsPerRadian + 0.5f) %
+                       ASTEROID_ROTATIONS;
+        int frame = asteroid.variant * ASTEROID_ROTATIONS + rotation;
+        // Quads skip the frame's clear border, so filtering at a reduced
+        // render scale never reaches the neighbouring frame.
+        int frameX = (frame % shelf.columns) * shelf.frameSize + 1;
+        int frameY = shelf.originY + (frame / shelf.columns) * shelf.frameSize + 1;
+        float size = (float)(shelf.frameSize - 2);
         
-        SDL_RenderDrawLine(gRenderer,
-                           current.p1.x + asteroid.position.x,
-                           current.p1.y + asteroid.position.y,
-                           current.p2.x + asteroid.position.x,
-                           current.p2.y + asteroid.position.y);
+        float u0 = frameX / atlasWidth;
+        float v0 = frameY / atlasHeight;
+        float u1 = u0 + size / atlasWidth;
+        float v1 = v0 + size / atlasHeight;
+        float x0 = (float)(realToInt(asteroid.position.x) - shelf.frameSize / 2 + 1);
+        float y0 = (float)(realToInt(asteroid.position.y) - shelf.frameSize / 2 + 1);
+        
+        SDL_Vertex *quad = &gSpriteVertices[i * 4];
+        quad[0] = { { x0, y0 }, color, { u0, v0 } };
+        quad[1] = { { x0 + size, y0 }, color, { u1, v0 } };
+        quad[2] = { { x0 + size, y0 + size }, color, { u1, v1 } };
+        quad[3] = { { x0, y0 + size }, color, { u0, v1 } };
     }
+    
+    SDL_RenderGeometry(gRenderer, gAsteroidAtlas, gSpriteVertices.data(), nSprites * 4,
+                       gSpriteIndices.data(), nSprites * 6);
+    gDrawCalls++;
 }
 
 static void renderShip(Ship ship)
@@ -690,14 +1707,15 @@ static void renderShip(Ship ship)
         
         SDL_SetRenderDrawColor(gRenderer, 255, 255, 255, 255);
         SDL_RenderDrawLine(gRenderer,
-                           current.p1.x + ship.position.x,
-                           current.p1.y + ship.position.y,
-                           current.p2.x + ship.position.x,
-                           current.p2.y + ship.position.y);
+                           realToInt(current.p1.x + ship.position.x),
+                           realToInt(current.p1.y + ship.position.y),
+                           realToInt(current.p2.x + ship.position.x),
+                           realToInt(current.p2.y + ship.position.y));
+        gDrawCalls++;
     }
 }
 
-static void renderProjectiles(std::vector<Projectile> projectiles)
+static void renderProjectiles(const std::vector<Projectile> &projectiles)
 {
     for (int projectileIndex = 0;
          projectileIndex < projectiles.size();
@@ -707,70 +1725,153 @@ static void renderProjectiles(std::vector<Projectile> projectiles)
     }
 }
 
-static void renderProjectile(Projectile &projectile)
+static void renderProjectile(const Projectile &projectile)
 {
     SDL_Rect rect = {
-        (int)projectile.position.x - PROJECTILE_SIZE / 2,
-        (int)projectile.position.y - PROJECTILE_SIZE / 2,
+        realToInt(projectile.position.x) - PROJECTILE_SIZE / 2,
+        realToInt(projectile.position.y) - PROJECTILE_SIZE / 2,
         PROJECTILE_SIZE,
         PROJECTILE_SIZE
     };
     
     SDL_SetRenderDrawColor(gRenderer, 255, 255, 255, 255);
     SDL_RenderFillRect(gRenderer, &rect);
+    gDrawCalls++;
 }
 
-static void renderText(const char *text, Vector2f position)
+static void renderText(const char *text, SDL_Point position)
 {
-    SDL_Color color = { 200, 200, 200 };
-    SDL_Surface *fontSurface = TTF_RenderText_Solid(gDefaultFont, text, color);
+    int nChars = (int)strlen(text);
+    int advance = (FONTATLAS_GLYPH_WIDTH + 1) * TEXT_SCALE;
+    int width = nChars * advance - TEXT_SCALE;
+    int height = FONTATLAS_GLYPH_HEIGHT * TEXT_SCALE;
     
-    if (fontSurface == nullptr)
+    SDL_SetTextureColorMod(gFontAtlas, 200, 200, 200);
+    
+    for (int charIndex = 0; charIndex < nChars; charIndex++)
     {
-        std::cout << "Unable to render font" << std::endl;
-        std::cout << TTF_GetError() << std::endl;
-        quit();
-        exit(1);
+        int glyphIndex = (unsigned char)text[charIndex] - FONTATLAS_FIRST_CHAR;
+        
+        // Spaces (glyph 0) and anything outside the atlas only advance.
+        if (glyphIndex <= 0 || glyphIndex >= FONTATLAS_N_GLYPHS)
+        {
+            continue;
+        }
+        
+        SDL_Rect srcRect = {
+            (glyphIndex % TEXT_ATLAS_COLUMNS) * FONTATLAS_GLYPH_WIDTH,
+            (glyphIndex / TEXT_ATLAS_COLUMNS) * FONTATLAS_GLYPH_HEIGHT,
+            FONTATLAS_GLYPH_WIDTH,
+            FONTATLAS_GLYPH_HEIGHT
+        };
+        
+        SDL_Rect dstRect = {
+            position.x - width / 2 + charIndex * advance,
+            position.y - height / 2,
+            FONTATLAS_GLYPH_WIDTH * TEXT_SCALE,
+            height
+        };
+        
+        SDL_RenderCopy(gRenderer, gFontAtlas, &srcRect, &dstRect);
+        gDrawCalls++;
     }
-    
-    SDL_Texture *fontTexture = SDL_CreateTextureFromSurface(gRenderer, fontSurface);
-    
-    if (fontTexture == nullptr)
+}
+
+static void updateRenderScale(double frameMs)
+{
+    if (!gDynamicResolution || gSceneTarget == nullptr)
     {
-        std::cout << "Unable to render font" << std::endl;
-        std::cout << SDL_GetError() << std::endl;
-        quit();
-        exit(1);
+        return;
     }
     
-    // I need to do this a better way.  I know how.  Just need to do it.
-    SDL_Rect srcRect = { 0, 0, 0, 0 };
-    SDL_QueryTexture(fontTexture, nullptr, nullptr, &srcRect.w, &srcRect.h);
-    
-    SDL_Rect dstRect = {
-        (int)position.x - srcRect.w / 2,
-        (int)position.y - srcRect.h / 2,
-        srcRect.w,
-        srcRect.h
-    };
+    if (frameMs > FRAME_BUDGET_MS * RENDERSCALE_OVER_BUDGET)
+    {
+        gOverBudgetFrames++;
+        gUnderBudgetFrames = 0;
+    }
+    else if (frameMs < FRAME_BUDGET_MS * RENDERSCALE_UNDER_BUDGET)
+    {
+        gUnderBudgetFrames++;
+        gOverBudgetFrames = 0;
+    }
     
-    SDL_RenderCopy(gRenderer, fontTexture, &srcRect, &dstRect);
+    if (gOverBudgetFrames >= RENDERSCALE_DROP_FRAMES && gRenderScale > RENDERSCALE_MIN)
+    {
+        gRenderScale = fmaxf(RENDERSCALE_MIN, gRenderScale - RENDERSCALE_STEP);
+        gOverBudgetFrames = 0;
+        gUnderBudgetFrames = 0;
+        
+        // Dropping straight after a raise means the raise was a mistake.
+        if (gJustRaised && gRaiseFrames < RENDERSCALE_MAX_RAISE_FRAMES)
+        {
+            gRaiseFrames *= 2;
+        }
+        
+        gJustRaised = false;
+        logMessage(LogLevel_Debug, "Render scale down to %.3f", gRenderScale);
+    }
+    else if (gUnderBudgetFrames >= gRaiseFrames && gRenderScale < 1.0f)
+    {
+        gRenderScale = fminf(1.0f, gRenderScale + RENDERSCALE_STEP);
+        gUnderBudgetFrames = 0;
+        gJustRaised = true;
+        logMessage(LogLevel_Debug, "Render scale up to %.3f", gRenderScale);
+    }
+    else if (gUnderBudgetFrames >= RENDERSCALE_MAX_RAISE_FRAMES)
+    {
+        // A long stable stretch clears the penalty from earlier failed raises.
+        gRaiseFrames = RENDERSCALE_RAISE_FRAMES;
+        gJustRaised = false;
+    }
+}
+
+static void publishTelemetry(double tickMs, double frameMs)
+{
+    TelemetrySample sample;
+    sample.tick = gTicks;
+    sample.tickMs = tickMs;
+    sample.frameMs = frameMs;
+    sample.asteroids = (uint32_t)gAsteroids.size();
+    sample.projectiles = (uint32_t)gProjectiles.size();
+    sample.particles = (uint32_t)gParticles.size();
+    sample.state = gState;
+    sample.shipX = realToFloat(gShip.position.x);
+    sample.shipY = realToFloat(gShip.position.y);
+    sample.shipAngle = realToFloat(gShip.angle);
+    sample.shipSpeed = realToFloat(gShip.speed);
+    
+    telemetryPublish(sample);
+}
+
+// xorshift32 rather than rand(), whose sequence depends on the C library
+// and so would differ between otherwise identical builds.
+static void randomSeed(Uint32 seed)
+{
+    gRandomState = (seed != 0) ? seed : 1;
+}
+
+static Uint32 randomNext()
+{
+    gRandomState ^= gRandomState << 13;
+    gRandomState ^= gRandomState >> 17;
+    gRandomState ^= gRandomState << 5;
+    return gRandomState;
 }
 
 static int randomDirection()
 {
-    int random = rand() % 2;
+    int random = randomNext() % 2;
     return (random == 0) ? -1 : 1;
 }
 
 static int random(int min, int max)
 {
-    return rand() % (max - min + 1) + min;
+    return (int)(randomNext() % (Uint32)(max - min + 1)) + min;
 }
 
-static float randomNormal()
+static Real randomNormal()
 {
-    return random(0, 100000) / 100000.0f;
+    return realFromInt(random(0, 100000)) / 100000;
 }
 
 static bool linesIntersect(Vector2f origin1, Vector2f origin2, Line l1, Line l2)
@@ -794,88 +1895,1262 @@ static bool linesIntersect(Vector2f origin1, Vector2f origin2, Line l1, Line l2)
 // http://bryceboe.com/2006/10/23/line-segment-intersection-algorithm/
 static bool counterClockwise(Vector2f a, Vector2f b, Vector2f c)
 {
-    return (c.y - a.y) * (b.x - a.x) > (b.y - a.y) * (c.x - a.x);
+    return realProductGreater(c.y - a.y, b.x - a.x, b.y - a.y, c.x - a.x);
 }
 
-static float distance(Vector2f p1, Vector2f p2)
+static Real distance(Vector2f p1, Vector2f p2)
 {
-    return sqrt(powf(p1.x - p2.x, 2.0f) +
-                powf(p1.y - p2.y, 2.0f));
+    return realLength(p1.x - p2.x, p1.y - p2.y);
 }
 
-static void wrapPosition(Vector2f &position, int bufferX, int bufferY)
+static void initPolygonTables()
 {
-    Vector2f wrapMin = {
-        -WRAPBUFFER_X,
-        -WRAPBUFFER_Y
-    };
-    
-    Vector2f wrapMax = {
-        WINDOW_WIDTH + WRAPBUFFER_X,
-        WINDOW_HEIGHT + WRAPBUFFER_Y
-    };
-    
-    if (position.x < wrapMin.x)
-    {
-        position.x = wrapMax.x - 1;
-    }
-    
-    if (position.x >= wrapMax.x)
+    for (int n = 1; n <= MAX_POLYGON_VERTICES; n++)
     {
-        position.x = wrapMin.x;
+        for (int i = 0; i < n; i++)
+        {
+            Real theta = REAL_TWO_PI * i / n;
+            gPolygonDirections[n][i] = { realCos(theta), realSin(theta) };
+        }
     }
+}
+
+// Fills gAsteroidShapes from ASTEROID_SHAPE_SEED.  Every radius slot is
+// filled, not just nVertices, so benchmarks can force the full count.
+static void initAsteroidShapes()
+{
+    AsteroidSize sizes[N_ASTEROID_SIZES] = {
+        ASTEROIDSIZE_SMALL, ASTEROIDSIZE_MEDIUM, ASTEROIDSIZE_LARGE
+    };
     
-    if (position.y < wrapMin.y)
-    {
-        position.y = wrapMax.y - 1;
-    }
+    randomSeed(ASTEROID_SHAPE_SEED);
     
-    if (position.y >= wrapMax.y)
+    for (int sizeIndex = 0; sizeIndex < N_ASTEROID_SIZES; sizeIndex++)
     {
-        position.y = wrapMin.y;
+        for (int variant = 0; variant < ASTEROID_VARIANTS; variant++)
+        {
+            Polygon &shape = gAsteroidShapes[sizeIndex][variant];
+            shape.nVertices = random(MIN_POLYGON_VERTICES, MAX_POLYGON_VERTICES);
+            
+            // Vertex distances from center scale with the size id.
+            for (int i = 0; i < MAX_POLYGON_VERTICES; i++)
+            {
+                Real jaggedness = ASTEROID_RADIUS_MIN +
+                                  (ASTEROID_RADIUS_MAX - ASTEROID_RADIUS_MIN) * randomNormal();
+                shape.radii[i] = (Uint8)realToInt(sizes[sizeIndex] * jaggedness);
+            }
+        }
     }
 }
 
-static void checkCollisions(Ship ship, std::vector<Asteroid> asteroids)
+// Row of gAsteroidShapes and gAtlasShelves for a size.
+static int asteroidSizeIndex(AsteroidSize size)
 {
-    for (int asteroidIndex = 0;
-         asteroidIndex < asteroids.size();
-         asteroidIndex++)
+    switch (size)
+    {
+        case ASTEROIDSIZE_SMALL:
+            return 0;
+        
+        case ASTEROIDSIZE_MEDIUM:
+            return 1;
+        
+        default:
+            return 2;
+    }
+}
+
+// Writes the asteroid's rotated vertices, relative to its position, and
+// returns how many there are.
+static int asteroidVertices(const Asteroid &asteroid, Vector2f *vertices)
+{
+    int n = asteroid.shape.nVertices;
+    Real c = realCos(asteroid.angle);
+    Real s = realSin(asteroid.angle);
+    
+    for (int i = 0; i < n; i++)
+    {
+        Vector2f direction = gPolygonDirections[n][i];
+        Real r = realFromInt(asteroid.shape.radii[i]);
+        
+        vertices[i] = {
+            r * (direction.x * c - direction.y * s),
+            r * (direction.x * s + direction.y * c)
+        };
+    }
+    
+    return n;
+}
+
+// World-space vertices of asteroids[index], transformed at most once per
+// stamp.  The entries grow to cover every asteroid in one step, so pointers
+// from earlier calls stay good until the asteroid vector grows.
+static const Vector2f *asteroidWorldVertices(TransformCache &cache,
+                                             const std::vector<Asteroid> &asteroids,
+                                             int index)
+{
+    if (cache.entries.size() < asteroids.size())
+    {
+        cache.entries.resize(asteroids.size());
+    }
+    
+    AsteroidTransform &entry = cache.entries[index];
+    
+    if (entry.stamp == cache.stamp)
+    {
+        cache.avoided++;
+        return entry.vertices;
+    }
+    
+    // asteroidVertices plus the position, in one pass.  The rotated offset
+    // is its own statement so no compiler fuses the add into a multiply-add
+    // and moves the result from where the uncached sum would be.
+    const Asteroid &asteroid = asteroids[index];
+    int n = asteroid.shape.nVertices;
+    Real c = realCos(asteroid.angle);
+    Real s = realSin(asteroid.angle);
+    
+    for (int i = 0; i < n; i++)
+    {
+        Vector2f direction = gPolygonDirections[n][i];
+        Real r = realFromInt(asteroid.shape.radii[i]);
+        Vector2f offset = {
+            r * (direction.x * c - direction.y * s),
+            r * (direction.x * s + direction.y * c)
+        };
+        
+        entry.vertices[i] = {
+            offset.x + asteroid.position.x,
+            offset.y + asteroid.position.y
+        };
+    }
+    
+    entry.stamp = cache.stamp;
+    cache.computed++;
+    
+    return entry.vertices;
+}
+
+static void invalidateTransforms(TransformCache &cache)
+{
+    cache.stamp++;
+    
+    if (cache.stamp == 0)
+    {
+        cache.stamp = 1;
+    }
+}
+
+static void dirtyTransform(TransformCache &cache, int index)
+{
+    if (index >= 0 && index < (int)cache.entries.size())
+    {
+        cache.entries[index].stamp = 0;
+    }
+}
+
+// Separating axis test for two convex polygons given in the same space.
+static bool convexPolygonsOverlap(const Vector2f *a, int nA, const Vector2f *b, int nB)
+{
+    for (int pass = 0; pass < 2; pass++)
+    {
+        const Vector2f *edges = (pass == 0) ? a : b;
+        int nEdges = (pass == 0) ? nA : nB;
+        
+        for (int i = 0; i < nEdges; i++)
+        {
+            Vector2f p1 = edges[i];
+            Vector2f p2 = edges[(i + 1) % nEdges];
+            Vector2f axis = { p1.y - p2.y, p2.x - p1.x };
+            
+            Real minA = a[0].x * axis.x + a[0].y * axis.y, maxA = minA;
+            Real minB = b[0].x * axis.x + b[0].y * axis.y, maxB = minB;
+            
+            for (int j = 1; j < nA; j++)
+            {
+                Real projection = a[j].x * axis.x + a[j].y * axis.y;
+                minA = std::min(minA, projection);
+                maxA = std::max(maxA, projection);
+            }
+            
+            for (int j = 1; j < nB; j++)
+            {
+                Real projection = b[j].x * axis.x + b[j].y * axis.y;
+                minB = std::min(minB, projection);
+                maxB = std::max(maxB, projection);
+            }
+            
+            if (maxA < minB || maxB < minA)
+            {
+                return false;
+            }
+        }
+    }
+    
+    return true;
+}
+
+// Jagged asteroids are concave but always star-shaped around their center,
+// so they are split into a fan of triangles and each is tested against the
+// ship triangle with SAT.  Unlike edge crossing this also catches the ship
+// sitting entirely inside an asteroid.
+static bool shipAsteroidOverlapSAT(const Ship &ship,
+                                   const std::vector<Asteroid> &asteroids,
+                                   int index,
+                                   TransformCache &transforms)
+{
+    const Asteroid &asteroid = asteroids[index];
+    
+    if (realLengthGreater(ship.position.x - asteroid.position.x,
+                          ship.position.y - asteroid.position.y,
+                          SHIP_RADIUS + asteroid.size * ASTEROID_RADIUS_MAX))
+    {
+        return false;
+    }
+    
+    Vector2f offset = {
+        ship.position.x - asteroid.position.x,
+        ship.position.y - asteroid.position.y
+    };
+    
+    Vector2f shipTriangle[N_SHIP_LINES];
+    
+    for (int i = 0; i < N_SHIP_LINES; i++)
+    {
+        shipTriangle[i] = {
+            ship.lines[i].p1.x + offset.x,
+            ship.lines[i].p1.y + offset.y
+        };
+    }
+    
+    // Back to the asteroid's frame, which keeps the products in the SAT
+    // small; exact in the fixed-point build.
+    const Vector2f *world = asteroidWorldVertices(transforms, asteroids, index);
+    Vector2f vertices[MAX_POLYGON_VERTICES];
+    int nVertices = asteroid.shape.nVertices;
+    
+    for (int i = 0; i < nVertices; i++)
+    {
+        vertices[i] = {
+            world[i].x - asteroid.position.x,
+            world[i].y - asteroid.position.y
+        };
+    }
+    
+    // Only the fan triangles whose angular sector the ship's bounding
+    // circle reaches can overlap it.  The sectors are only a filter, so
+    // they are found in float and padded by one on each side; a rounding
+    // difference in atan2f between builds can't change which triangles
+    // decide the result.
+    int first = 0;
+    int count = nVertices;
+    float d = realToFloat(realLength(offset.x, offset.y));
+    float shipRadius = realToFloat(SHIP_RADIUS);
+    
+    if (d > shipRadius)
+    {
+        float theta = (2 * M_PI) / nVertices;
+        float phi = atan2f(realToFloat(offset.y), realToFloat(offset.x)) -
+                    realToFloat(asteroid.angle);
+        float halfWidth = asinf(shipRadius / d);
+        
+        first = (int)floorf((phi - halfWidth) / theta) - 1;
+        count = (int)floorf((phi + halfWidth) / theta) - first + 2;
+        first = ((first % nVertices) + nVertices) % nVertices;
+        
+        if (count > nVertices)
+        {
+            count = nVertices;
+        }
+    }
+    
+    for (int k = 0; k < count; k++)
     {
-        Asteroid currentAsteroid = asteroids[asteroidIndex];
-        checkCollision(ship, currentAsteroid);
+        int i = (first + k) % nVertices;
+        Vector2f fanTriangle[3] = {
+            { realFromInt(0), realFromInt(0) },
+            vertices[i],
+            vertices[(i + 1) % nVertices]
+        };
+        
+        if (convexPolygonsOverlap(shipTriangle, N_SHIP_LINES, fanTriangle, 3))
+        {
+            return true;
+        }
     }
+    
+    return false;
 }
 
-static void checkCollision(Ship ship, Asteroid asteroid)
+// The previous pairwise edge-crossing test, kept as the benchmark baseline.
+static bool shipAsteroidOverlapSegments(const Ship &ship, const Asteroid &asteroid)
 {
+    Vector2f vertices[MAX_POLYGON_VERTICES];
+    int nVertices = asteroidVertices(asteroid, vertices);
+    
     for (int aLineIndex = 0;
-         aLineIndex < N_LINES;
+         aLineIndex < nVertices;
          aLineIndex++)
     {
-        Line currentAsteroidLine = asteroid.shape.lines[aLineIndex];
+        Line currentAsteroidLine = {
+            vertices[aLineIndex],
+            vertices[(aLineIndex + 1) % nVertices]
+        };
         
         for (int sLineIndex = 0;
              sLineIndex < N_SHIP_LINES;
              sLineIndex++)
         {
-            Line currentShipLine = ship.lines[sLineIndex];
-            
             if (linesIntersect(ship.position,
                                asteroid.position,
-                               currentShipLine,
+                               ship.lines[sLineIndex],
                                currentAsteroidLine))
             {
-                explode(ship.position);
-                gState = GameState_Lost;
+                return true;
+            }
+        }
+    }
+    
+    return false;
+}
+
+// Fills batch with the edges of an outline given in world space, ready for
+// segmentBatchIntersect.
+static void asteroidEdgeBatch(const Vector2f *vertices, int nVertices, SegmentBatch &batch)
+{
+    for (int i = 0; i < nVertices; i++)
+    {
+        Vector2f p1 = vertices[i];
+        Vector2f p2 = vertices[(i + 1) % nVertices];
+        
+        batch.x1[i] = realToFloat(p1.x);
+        batch.y1[i] = realToFloat(p1.y);
+        batch.x2[i] = realToFloat(p2.x);
+        batch.y2[i] = realToFloat(p2.y);
+    }
+    
+    batch.count = nVertices;
+}
+
+// Fills batch with the edges of a world-space outline on the integer grid,
+// ready for segmentBatchIntersectInt.  The grid is fixed in world space and
+// only the numbering starts at origin, the asteroid's position, so two
+// asteroids' edges land on the same points whichever one the test is built
+// around.
+static void asteroidEdgeBatchInt(const Vector2f *vertices, int nVertices, Vector2f origin,
+                                 SegmentBatchInt &batch)
+{
+    Sint32 originX = edgeGridCoordinate(origin.x);
+    Sint32 originY = edgeGridCoordinate(origin.y);
+    Sint32 gridX[MAX_POLYGON_VERTICES + 1];
+    Sint32 gridY[MAX_POLYGON_VERTICES + 1];
+    
+    // Each vertex once; the copy at the end closes the outline.
+    for (int i = 0; i < nVertices; i++)
+    {
+        gridX[i] = edgeGridCoordinate(vertices[i].x) - originX;
+        gridY[i] = edgeGridCoordinate(vertices[i].y) - originY;
+    }
+    
+    gridX[nVertices] = gridX[0];
+    gridY[nVertices] = gridY[0];
+    
+    for (int i = 0; i < nVertices; i++)
+    {
+        segmentBatchIntSet(batch, i, gridX[i], gridY[i], gridX[i + 1], gridY[i + 1]);
+    }
+    
+    batch.count = nVertices;
+}
+
+// Rounds down onto the collision grid; exact in the fixed-point build.
+static Sint32 edgeGridCoordinate(Real value)
+{
+#if ASTEROIDS_FIXED_POINT
+    return value.raw >> (FIXED_FRACTION_BITS - EDGE_GRID_BITS);
+#else
+    return (Sint32)floorf(value * (1 << EDGE_GRID_BITS));
+#endif
+}
+
+// vertices is the asteroid's world-space outline.
+static void asteroidEdges(const Asteroid &asteroid, const Vector2f *vertices, AsteroidEdges &edges)
+{
+#if ASTEROIDS_FIXED_POINT
+    asteroidEdgeBatchInt(vertices, asteroid.shape.nVertices, asteroid.position, edges.batch);
+    edges.origin = asteroid.position;
+    edges.radius = asteroid.size * ASTEROID_RADIUS_MAX;
+#else
+    asteroidEdgeBatch(vertices, asteroid.shape.nVertices, edges.batch);
+#endif
+}
+
+// True when the segment from p1 to p2, in world space, crosses any edge.
+static bool segmentCrossesEdges(Vector2f p1, Vector2f p2, const AsteroidEdges &edges)
+{
+#if ASTEROIDS_FIXED_POINT
+    Vector2f a = { p1.x - edges.origin.x, p1.y - edges.origin.y };
+    Vector2f b = { p2.x - edges.origin.x, p2.y - edges.origin.y };
+    
+    if (std::max(a.x, b.x) < -edges.radius || std::min(a.x, b.x) > edges.radius ||
+        std::max(a.y, b.y) < -edges.radius || std::min(a.y, b.y) > edges.radius)
+    {
+        return false;
+    }
+    
+    Sint32 originX = edgeGridCoordinate(edges.origin.x);
+    Sint32 originY = edgeGridCoordinate(edges.origin.y);
+    Sint32 ax = edgeGridCoordinate(p1.x) - originX, ay = edgeGridCoordinate(p1.y) - originY;
+    Sint32 bx = edgeGridCoordinate(p2.x) - originX, by = edgeGridCoordinate(p2.y) - originY;
+    
+    // Projectile steps and asteroid edges that reach the box always fit
+    // the SIMD kernels; anything longer takes the 64-bit scalar path, on
+    // the same grid.
+    if (abs(ax) >= SEGMENT_BATCH_INT_LIMIT || abs(ay) >= SEGMENT_BATCH_INT_LIMIT ||
+        abs(bx) >= SEGMENT_BATCH_INT_LIMIT || abs(by) >= SEGMENT_BATCH_INT_LIMIT)
+    {
+        return segmentBatchIntersectIntScalar(ax, ay, bx, by, edges.batch) != 0;
+    }
+    
+    return segmentBatchIntersectInt(ax, ay, bx, by, edges.batch) != 0;
+#else
+    return segmentBatchIntersect(p1.x, p1.y, p2.x, p2.y, edges.batch) != 0;
+#endif
+}
+
+// True when any edge of a closed world-space outline crosses edges.  The
+// fixed-point build moves each vertex onto the grid once, rather than at
+// both ends of every edge as segmentCrossesEdges would.
+static bool outlineCrossesEdges(const Vector2f *vertices, int nVertices,
+                                const AsteroidEdges &edges)
+{
+#if ASTEROIDS_FIXED_POINT
+    Sint32 originX = edgeGridCoordinate(edges.origin.x);
+    Sint32 originY = edgeGridCoordinate(edges.origin.y);
+    // Every vertex of edges is within radius of origin; two grid steps
+    // cover rounding both of them down.
+    Sint32 reach = edgeGridCoordinate(edges.radius) + 2;
+    Sint32 gridX[MAX_POLYGON_VERTICES + 1];
+    Sint32 gridY[MAX_POLYGON_VERTICES + 1];
+    
+    for (int i = 0; i < nVertices; i++)
+    {
+        gridX[i] = edgeGridCoordinate(vertices[i].x) - originX;
+        gridY[i] = edgeGridCoordinate(vertices[i].y) - originY;
+    }
+    
+    gridX[nVertices] = gridX[0];
+    gridY[nVertices] = gridY[0];
+    
+    for (int i = 0; i < nVertices; i++)
+    {
+        Sint32 ax = gridX[i], ay = gridY[i];
+        Sint32 bx = gridX[i + 1], by = gridY[i + 1];
+        
+        if (std::max(ax, bx) < -reach || std::min(ax, bx) > reach ||
+            std::max(ay, by) < -reach || std::min(ay, by) > reach)
+        {
+            continue;
+        }
+        
+        if (abs(ax) >= SEGMENT_BATCH_INT_LIMIT || abs(ay) >= SEGMENT_BATCH_INT_LIMIT ||
+            abs(bx) >= SEGMENT_BATCH_INT_LIMIT || abs(by) >= SEGMENT_BATCH_INT_LIMIT)
+        {
+            if (segmentBatchIntersectIntScalar(ax, ay, bx, by, edges.batch) != 0)
+            {
+                return true;
+            }
+        }
+        else if (segmentBatchIntersectInt(ax, ay, bx, by, edges.batch) != 0)
+        {
+            return true;
+        }
+    }
+    
+    return false;
+#else
+    for (int i = 0; i < nVertices; i++)
+    {
+        Vector2f p1 = vertices[i];
+        Vector2f p2 = vertices[(i + 1) % nVertices];
+        
+        if (segmentBatchIntersect(p1.x, p1.y, p2.x, p2.y, edges.batch) != 0)
+        {
+            return true;
+        }
+    }
+    
+    return false;
+#endif
+}
+
+// Sort-and-sweep along x, band by band.  The list survives between ticks,
+// so after the first sort it is nearly in order and an insertion sort fixes
+// it in about one pass.  Returns the number of overlapping pairs.
+static int collideAsteroids(std::vector<Asteroid> &asteroids,
+                            std::vector<SweepEntry> &sweep,
+                            TransformCache &transforms)
+{
+    int nAsteroids = (int)asteroids.size();
+    int nEntries = (int)sweep.size();
+    int kept = 0;
+    
+    // Asteroids are only removed by moving the last one into the hole and
+    // only added at the end, so the entries that survive this filter always
+    // cover indices 0..kept-1 and the rest can be appended in order.
+    for (int i = 0; i < nEntries; i++)
+    {
+        if (sweep[i].index < nAsteroids)
+        {
+            sweep[kept++] = sweep[i];
+        }
+    }
+    
+    sweep.resize(kept);
+    
+    for (int index = kept; index < nAsteroids; index++)
+    {
+        SweepEntry entry = {};
+        entry.index = index;
+        sweep.push_back(entry);
+    }
+    
+    for (int i = 0; i < nAsteroids; i++)
+    {
+        const Asteroid &asteroid = asteroids[sweep[i].index];
+        Real radius = asteroid.size * ASTEROID_RADIUS_MAX;
+        
+        sweep[i].band = realFloor(asteroid.position.y / ASTEROID_SWEEP_BAND);
+        sweep[i].minX = asteroid.position.x - radius;
+        sweep[i].maxX = asteroid.position.x + radius;
+        sweep[i].minY = asteroid.position.y - radius;
+        sweep[i].maxY = asteroid.position.y + radius;
+    }
+    
+    // A big batch of new entries (a restart, a loaded field) is no longer
+    // nearly sorted, and insertion sort would go quadratic on it.
+    if (nAsteroids - kept > nAsteroids / 4)
+    {
+        std::sort(sweep.begin(), sweep.end(), sweepBefore);
+    }
+    else
+    {
+        for (int i = 1; i < nAsteroids; i++)
+        {
+            SweepEntry entry = sweep[i];
+            int j = i - 1;
+            
+            while (j >= 0 && sweepBefore(entry, sweep[j]))
+            {
+                sweep[j + 1] = sweep[j];
+                j--;
+            }
+            
+            sweep[j + 1] = entry;
+        }
+    }
+    
+    int contacts = 0;
+    int bandEnd = 0;
+    int nextBandEnd = 0;
+    int cursor = 0;
+    
+    for (int i = 0; i < nAsteroids; i++)
+    {
+        const SweepEntry &a = sweep[i];
+        
+        if (i == bandEnd)
+        {
+            while (bandEnd < nAsteroids && sweep[bandEnd].band == a.band)
+            {
+                bandEnd++;
+            }
+            
+            cursor = bandEnd;
+            nextBandEnd = bandEnd;
+            
+            while (nextBandEnd < nAsteroids && sweep[nextBandEnd].band == a.band + 1)
+            {
+                nextBandEnd++;
+            }
+        }
+        
+        // Later entries in the same band start at or after a.minX.
+        for (int j = i + 1; j < bandEnd && sweep[j].minX <= a.maxX; j++)
+        {
+            contacts += collideAsteroidPair(asteroids, transforms, a, sweep[j]);
+        }
+        
+        // The band below can also hold rocks that started to the left, up
+        // to one full width back.  a.minX only grows, so the cursor does too.
+        while (cursor < nextBandEnd && sweep[cursor].minX < a.minX - ASTEROID_SWEEP_BAND)
+        {
+            cursor++;
+        }
+        
+        for (int j = cursor; j < nextBandEnd && sweep[j].minX <= a.maxX; j++)
+        {
+            if (sweep[j].maxX >= a.minX)
+            {
+                contacts += collideAsteroidPair(asteroids, transforms, a, sweep[j]);
+            }
+        }
+    }
+    
+    return contacts;
+}
+
+static bool sweepBefore(const SweepEntry &a, const SweepEntry &b)
+{
+    return (a.band != b.band) ? (a.band < b.band) : (a.minX < b.minX);
+}
+
+// Bounces the pair if their boxes and then their outlines overlap, and
+// returns 1 if they did.
+static int collideAsteroidPair(std::vector<Asteroid> &asteroids,
+                               TransformCache &transforms,
+                               const SweepEntry &a,
+                               const SweepEntry &b)
+{
+    if (b.maxY < a.minY || b.minY > a.maxY)
+    {
+        return 0;
+    }
+    
+    if (!asteroidsOverlap(asteroids, transforms, a.index, b.index))
+    {
+        return 0;
+    }
+    
+    bounceAsteroids(asteroids[a.index], asteroids[b.index]);
+    
+    return 1;
+}
+
+// True when any edge of asteroid a crosses an edge of asteroid b.  Only
+// pairs that pass the distance test need either outline.
+static bool asteroidsOverlap(const std::vector<Asteroid> &asteroids,
+                             TransformCache &transforms,
+                             int a,
+                             int b)
+{
+    const Asteroid &asteroidA = asteroids[a];
+    const Asteroid &asteroidB = asteroids[b];
+    
+    if (realLengthGreater(asteroidA.position.x - asteroidB.position.x,
+                          asteroidA.position.y - asteroidB.position.y,
+                          (asteroidA.size + asteroidB.size) * ASTEROID_RADIUS_MAX))
+    {
+        return false;
+    }
+    
+    return outlinesCross(asteroids, transforms, a, b);
+}
+
+// The edge test behind asteroidsOverlap.  Kept apart so the common
+// distance reject above stays a cheap leaf.
+static bool outlinesCross(const std::vector<Asteroid> &asteroids,
+                          TransformCache &transforms,
+                          int a,
+                          int b)
+{
+    const Vector2f *verticesA = asteroidWorldVertices(transforms, asteroids, a);
+    const Vector2f *verticesB = asteroidWorldVertices(transforms, asteroids, b);
+    AsteroidEdges edgesA;
+    asteroidEdges(asteroids[a], verticesA, edgesA);
+    
+    return outlineCrossesEdges(verticesB, asteroids[b].shape.nVertices, edgesA);
+}
+
+// Elastic collision along the line between the centers, with mass growing
+// with the rock's area.  Pairs that are already separating are left alone,
+// so rocks still overlapping after a bounce drift apart instead of being
+// pulled back together.  The two halves of a split start at the same point
+// with random velocities, so they bounce whenever those converge.
+static void bounceAsteroids(Asteroid &a, Asteroid &b)
+{
+    Vector2f normal = {
+        b.position.x - a.position.x,
+        b.position.y - a.position.y
+    };
+    
+    // Most touching pairs are already separating, which the unnormalized
+    // normal shows as well, without the square root.
+    if ((b.velocity.x - a.velocity.x) * normal.x +
+        (b.velocity.y - a.velocity.y) * normal.y >= realFromInt(0))
+    {
+        return;
+    }
+    
+    Real length = distance(a.position, b.position);
+    
+    if (length == realFromInt(0))
+    {
+        return;
+    }
+    
+    normal.x /= length;
+    normal.y /= length;
+    
+    Real approach = (b.velocity.x - a.velocity.x) * normal.x +
+                    (b.velocity.y - a.velocity.y) * normal.y;
+    
+    if (approach >= realFromInt(0))
+    {
+        return;
+    }
+    
+    // Each rock's change in speed along the normal is 2 * approach scaled
+    // by the other's share of the total mass.  Worked from the masses
+    // rather than their inverses, which would be far below fixed point's
+    // resolution.
+    int massA = a.size * a.size;
+    int massB = b.size * b.size;
+    Real changeA = approach * (2 * massB) / (massA + massB);
+    Real changeB = approach * (2 * massA) / (massA + massB);
+    
+    a.velocity.x += changeA * normal.x;
+    a.velocity.y += changeA * normal.y;
+    b.velocity.x -= changeB * normal.x;
+    b.velocity.y -= changeB * normal.y;
+}
+
+// Fields of 10k-100k asteroids at a constant density, stepped for a
+// number of ticks.  Brute force all-pairs runs on the smallest field to
+// check that sweep-and-prune finds the same contacts.
+static void runAsteroidBenchmark()
+{
+    const int fieldSizes[] = { 10000, 20000, 50000, 100000 };
+    const int nTicks = 60;
+    const Real spacing = realFromInt(200); // Pixels of field per asteroid, each way.
+    
+    AsteroidSize sizes[] = {
+        ASTEROIDSIZE_SMALL, ASTEROIDSIZE_MEDIUM, ASTEROIDSIZE_LARGE
+    };
+    
+    for (int fieldIndex = 0; fieldIndex < 4; fieldIndex++)
+    {
+        int nAsteroids = fieldSizes[fieldIndex];
+        Real side = realSqrt(realFromInt(nAsteroids)) * spacing;
+        
+        randomSeed(1);
+        
+        std::vector<Asteroid> asteroids;
+        std::vector<SweepEntry> sweep;
+        TransformCache transforms;
+        asteroids.reserve(nAsteroids);
+        sweep.reserve(nAsteroids);
+        
+        for (int i = 0; i < nAsteroids; i++)
+        {
+            Asteroid asteroid = createAsteroid(sizes[random(0, 2)]);
+            asteroid.position = { randomNormal() * side, randomNormal() * side };
+            asteroids.push_back(asteroid);
+        }
+        
+        if (fieldIndex == 0)
+        {
+            int bruteContacts = 0;
+            Uint64 start = SDL_GetPerformanceCounter();
+            
+            for (int i = 0; i < nAsteroids; i++)
+            {
+                for (int j = i + 1; j < nAsteroids; j++)
+                {
+                    bruteContacts += asteroidsOverlap(asteroids, transforms, i, j);
+                }
             }
+            
+            double ms = (SDL_GetPerformanceCounter() - start) * 1000.0 /
+                        SDL_GetPerformanceFrequency();
+            std::vector<Asteroid> copy = asteroids;
+            std::vector<SweepEntry> copySweep;
+            TransformCache copyTransforms;
+            int sweepContacts = collideAsteroids(copy, copySweep, copyTransforms);
+            
+            std::cout << "all pairs, " << nAsteroids << " asteroids: " << ms
+                      << " ms/tick, " << bruteContacts << " contacts (sweep found "
+                      << sweepContacts << ")" << std::endl;
+        }
+        
+        // The first call sorts from scratch; time the steady state.
+        invalidateTransforms(transforms);
+        collideAsteroids(asteroids, sweep, transforms);
+        
+        int contacts = 0;
+        Uint64 ticks = 0;
+        
+        for (int tick = 0; tick < nTicks; tick++)
+        {
+            for (int i = 0; i < nAsteroids; i++)
+            {
+                asteroids[i].position.x += asteroids[i].velocity.x;
+                asteroids[i].position.y += asteroids[i].velocity.y;
+                asteroids[i].angle += asteroids[i].angularVelocity;
+            }
+            
+            invalidateTransforms(transforms);
+            
+            Uint64 start = SDL_GetPerformanceCounter();
+            contacts += collideAsteroids(asteroids, sweep, transforms);
+            ticks += SDL_GetPerformanceCounter() - start;
+        }
+        
+        double ms = ticks * 1000.0 / SDL_GetPerformanceFrequency() / nTicks;
+        std::cout << "sweep, " << nAsteroids << " asteroids: " << ms << " ms/tick, "
+                  << ms * 1e6 / nAsteroids << " ns/asteroid, "
+                  << (double)contacts / nTicks << " contacts/tick" << std::endl;
+    }
+}
+
+// Writes the current world.  Uses plain file descriptors rather than
+// stdio so dumping mid-game doesn't trip --strict-alloc.
+static bool writeScenario(const char *path)
+{
+    ScenarioHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SCENARIO_MAGIC, sizeof(header.magic));
+    header.version = SCENARIO_VERSION;
+    header.asteroidSize = sizeof(Asteroid);
+    header.shipSize = sizeof(Ship);
+    header.projectileSize = sizeof(Projectile);
+    header.state = gState;
+    header.ticks = gTicks;
+    header.realFormat = REAL_FORMAT;
+    header.nAsteroids = gAsteroids.size();
+    header.nProjectiles = gProjectiles.size();
+    header.nParticles = gParticles.size();
+    
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    
+    if (fd < 0)
+    {
+        logMessage(LogLevel_Warning, "Unable to write scenario %s: %s", path, strerror(errno));
+        return false;
+    }
+    
+    // The header goes out twice: first as a placeholder, then again once
+    // the array offsets are known.
+    Uint64 offset = 0;
+    bool ok = writeScenarioArray(fd, &header, sizeof(header), offset);
+    
+    header.asteroidOffset = offset;
+    ok = ok && writeScenarioArray(fd, gAsteroids.data(),
+                                  header.nAsteroids * sizeof(Asteroid), offset);
+    header.shipOffset = offset;
+    ok = ok && writeScenarioArray(fd, &gShip, sizeof(Ship), offset);
+    header.projectileOffset = offset;
+    ok = ok && writeScenarioArray(fd, gProjectiles.data(),
+                                  header.nProjectiles * sizeof(Projectile), offset);
+    header.particleOffset = offset;
+    ok = ok && writeScenarioArray(fd, gParticles.data(),
+                                  header.nParticles * sizeof(Projectile), offset);
+    header.fileSize = offset;
+    ok = ok && pwrite(fd, &header, sizeof(header), 0) == sizeof(header);
+    // Taken before close(), which is free to change errno.
+    int error = ok ? 0 : errno;
+    
+    if (close(fd) != 0 && ok)
+    {
+        ok = false;
+        error = errno;
+    }
+    
+    if (!ok)
+    {
+        logMessage(LogLevel_Warning, "Unable to write scenario %s: %s", path, strerror(error));
+        return false;
+    }
+    
+    logMessage(LogLevel_Info, "Wrote scenario %s: %d asteroids, %d projectiles",
+               path, (int)header.nAsteroids, (int)header.nProjectiles);
+    
+    return true;
+}
+
+// Appends size bytes and pads the file to the next SCENARIO_ALIGNMENT.
+static bool writeScenarioArray(int fd, const void *data, Uint64 size, Uint64 &offset)
+{
+    static const char padding[SCENARIO_ALIGNMENT] = { 0 };
+    const char *bytes = (const char *)data;
+    Uint64 written = 0;
+    
+    while (written < size)
+    {
+        ssize_t result = write(fd, bytes + written, size - written);
+        
+        if (result <= 0)
+        {
+            return false;
+        }
+        
+        written += result;
+    }
+    
+    Uint64 padded = (size + SCENARIO_ALIGNMENT - 1) / SCENARIO_ALIGNMENT * SCENARIO_ALIGNMENT;
+    
+    if (padded > size && write(fd, padding, padded - size) != (ssize_t)(padded - size))
+    {
+        return false;
+    }
+    
+    offset += padded;
+    
+    return true;
+}
+
+// Maps the file and copies each array straight into the world.  Nothing is
+// changed unless the whole file checks out.
+static bool loadScenario(const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    struct stat info;
+    
+    if (fd < 0 || fstat(fd, &info) != 0)
+    {
+        logMessage(LogLevel_Error, "Unable to open scenario %s: %s", path, strerror(errno));
+        
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        
+        return false;
+    }
+    
+    Uint64 fileSize = info.st_size;
+    
+    if (fileSize < sizeof(ScenarioHeader))
+    {
+        logMessage(LogLevel_Error, "Unable to map scenario %s: %llu bytes is too small",
+                   path, (unsigned long long)fileSize);
+        close(fd);
+        return false;
+    }
+    
+    void *memory = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    int error = errno;
+    close(fd);
+    
+    if (memory == MAP_FAILED)
+    {
+        logMessage(LogLevel_Error, "Unable to map scenario %s: %s", path, strerror(error));
+        return false;
+    }
+    
+    const char *bytes = (const char *)memory;
+    const ScenarioHeader *header = (const ScenarioHeader *)memory;
+    
+    // Offsets are checked against the real file size so a truncated or
+    // corrupt file can't send the copies past the end of the mapping.
+    bool valid = memcmp(header->magic, SCENARIO_MAGIC, sizeof(header->magic)) == 0 &&
+                 header->version == SCENARIO_VERSION &&
+                 header->asteroidSize == sizeof(Asteroid) &&
+                 header->shipSize == sizeof(Ship) &&
+                 header->projectileSize == sizeof(Projectile) &&
+                 header->realFormat == REAL_FORMAT &&
+                 header->fileSize == fileSize &&
+                 scenarioArrayFits(header->asteroidOffset, header->nAsteroids,
+                                   sizeof(Asteroid), alignof(Asteroid), fileSize) &&
+                 scenarioArrayFits(header->shipOffset, 1,
+                                   sizeof(Ship), alignof(Ship), fileSize) &&
+                 scenarioArrayFits(header->projectileOffset, header->nProjectiles,
+                                   sizeof(Projectile), alignof(Projectile), fileSize) &&
+                 scenarioArrayFits(header->particleOffset, header->nParticles,
+                                   sizeof(Projectile), alignof(Projectile), fileSize);
+    
+    if (!valid)
+    {
+        logMessage(LogLevel_Error, "%s is not a version %u scenario for this build",
+                   path, SCENARIO_VERSION);
+        munmap(memory, fileSize);
+        return false;
+    }
+    
+    const Asteroid *asteroids = (const Asteroid *)(bytes + header->asteroidOffset);
+    const Ship *ship = (const Ship *)(bytes + header->shipOffset);
+    const Projectile *projectiles = (const Projectile *)(bytes + header->projectileOffset);
+    const Projectile *particles = (const Projectile *)(bytes + header->particleOffset);
+    
+    // The records index tables, pick code paths and feed wraps that only
+    // step back by one turn or one screen, so anything out of range would
+    // be read as if it were real.
+    const char *invalid = nullptr;
+    
+    if (header->state < GameState_Game || header->state > GameState_Won)
+    {
+        invalid = "game state";
+    }
+    else if (!scenarioShipValid(*ship))
+    {
+        invalid = "ship";
+    }
+    
+    for (Uint64 i = 0; invalid == nullptr && i < header->nAsteroids; i++)
+    {
+        if (!scenarioAsteroidValid(asteroids[i]))
+        {
+            invalid = "asteroid";
+        }
+    }
+    
+    for (Uint64 i = 0; invalid == nullptr && i < header->nProjectiles; i++)
+    {
+        if (!scenarioProjectileValid(projectiles[i], PROJECTILE_LIFETIME, PROJECTILE_SPEED))
+        {
+            invalid = "projectile";
+        }
+    }
+    
+    for (Uint64 i = 0; invalid == nullptr && i < header->nParticles; i++)
+    {
+        if (!scenarioProjectileValid(particles[i], PARTICLE_LIFETIME, PARTICLE_SPEED))
+        {
+            invalid = "particle";
+        }
+    }
+    
+    if (invalid != nullptr)
+    {
+        logMessage(LogLevel_Error, "%s holds an invalid %s", path, invalid);
+        munmap(memory, fileSize);
+        return false;
+    }
+    
+    // Room for the field to split all the way down and for the usual
+    // shots and debris on top of what was saved, before the first tick.
+    size_t peakAsteroids = ASTEROID_CAPACITY;
+    
+    for (Uint64 i = 0; i < header->nAsteroids; i++)
+    {
+        peakAsteroids += asteroidPieces(asteroids[i].size);
+    }
+    
+    reserveAsteroids(peakAsteroids);
+    gProjectiles.reserve(header->nProjectiles + PROJECTILE_CAPACITY);
+    gParticles.reserve(header->nParticles + PARTICLE_CAPACITY);
+    gAsteroids.assign(asteroids, asteroids + header->nAsteroids);
+    gProjectiles.assign(projectiles, projectiles + header->nProjectiles);
+    gParticles.assign(particles, particles + header->nParticles);
+    memcpy(&gShip, ship, sizeof(Ship));
+    orientShip(gShip);
+    gState = (GameState)header->state;
+    
+    // Held keys belong to whoever is playing now, not whoever dumped.
+    gShip.turnLeft = false;
+    gShip.turnRight = false;
+    gShip.thrusting = false;
+    gShip.shooting = false;
+    
+    logMessage(LogLevel_Info, "Loaded scenario %s: %d asteroids from tick %u",
+               path, (int)header->nAsteroids, header->ticks);
+    munmap(memory, fileSize);
+    
+    return true;
+}
+
+// True if count elements of elementSize at offset are aligned and lie
+// inside the file, worked without any sum or product that could wrap.
+static bool scenarioArrayFits(Uint64 offset, Uint64 count, Uint64 elementSize,
+                              Uint64 alignment, Uint64 fileSize)
+{
+    return offset % alignment == 0 &&
+           offset <= fileSize &&
+           count <= (fileSize - offset) / elementSize;
+}
+
+static bool scenarioAsteroidValid(const Asteroid &asteroid)
+{
+    if ((asteroid.size != ASTEROIDSIZE_SMALL &&
+         asteroid.size != ASTEROIDSIZE_MEDIUM &&
+         asteroid.size != ASTEROIDSIZE_LARGE) ||
+        asteroid.shape.nVertices < MIN_POLYGON_VERTICES ||
+        asteroid.shape.nVertices > MAX_POLYGON_VERTICES ||
+        asteroid.variant >= ASTEROID_VARIANTS ||
+        !scenarioPositionValid(asteroid.position) ||
+        !scenarioVelocityValid(asteroid.velocity, SCENARIO_ASTEROID_SPEED_MAX) ||
+        !scenarioAngleValid(asteroid.angle) ||
+        !scenarioRealInRange(asteroid.angularVelocity,
+                             -ASTEROID_ANGULARSPEED, ASTEROID_ANGULARSPEED))
+    {
+        return false;
+    }
+    
+    // The outline has to be its variant's, so the sprite matches what
+    // collides; that also keeps every radius within the collision culls'
+    // size * ASTEROID_RADIUS_MAX reach.
+    const Polygon &stock = gAsteroidShapes[asteroidSizeIndex(asteroid.size)][asteroid.variant];
+    
+    if (asteroid.shape.nVertices != stock.nVertices)
+    {
+        return false;
+    }
+    
+    for (int i = 0; i < asteroid.shape.nVertices; i++)
+    {
+        if (asteroid.shape.radii[i] != stock.radii[i])
+        {
+            return false;
         }
     }
+    
+    return true;
+}
+
+// The held-key flags and outline aren't checked, since loading replaces
+// them.
+static bool scenarioShipValid(const Ship &ship)
+{
+    return scenarioPositionValid(ship.position) &&
+           scenarioVelocityValid(ship.velocity, SHIP_MAXSPEED) &&
+           scenarioRealInRange(ship.speed, realFromInt(0), SHIP_MAXSPEED) &&
+           scenarioAngleValid(ship.angle) &&
+           ship.cooldown >= 0 &&
+           ship.cooldown < PROJECTILE_COOLDOWN;
+}
+
+// Live shots and particles are removed the tick they reach lifeTime.
+static bool scenarioProjectileValid(const Projectile &projectile, int lifeTime, Real maxSpeed)
+{
+    return scenarioPositionValid(projectile.position) &&
+           scenarioVelocityValid(projectile.velocity, maxSpeed) &&
+           projectile.lifeCounter >= 0 &&
+           projectile.lifeCounter < lifeTime;
+}
+
+// Every check is written as value-inside-range, so a float NaN, which
+// fails every comparison, is rejected too.
+static bool scenarioRealInRange(Real value, Real min, Real max)
+{
+    return value >= min && value <= max;
+}
+
+// Within the one turn the updates keep angles to.
+static bool scenarioAngleValid(Real angle)
+{
+    return angle >= realFromInt(0) && angle < REAL_TWO_PI;
+}
+
+// Within the box wrapPosition keeps everything to.
+static bool scenarioPositionValid(Vector2f position)
+{
+    return position.x >= realFromInt(-WRAPBUFFER_X) &&
+           position.x < realFromInt(WINDOW_WIDTH + WRAPBUFFER_X) &&
+           position.y >= realFromInt(-WRAPBUFFER_Y) &&
+           position.y < realFromInt(WINDOW_HEIGHT + WRAPBUFFER_Y);
+}
+
+static bool scenarioVelocityValid(Vector2f velocity, Real maxSpeed)
+{
+    return scenarioRealInRange(velocity.x, -maxSpeed, maxSpeed) &&
+           scenarioRealInRange(velocity.y, -maxSpeed, maxSpeed);
+}
+
+// Writes a random field of nAsteroids to path, then times loading it back.
+static void runScenarioBenchmark(const char *path, int nAsteroids)
+{
+    AsteroidSize sizes[] = {
+        ASTEROIDSIZE_SMALL, ASTEROIDSIZE_MEDIUM, ASTEROIDSIZE_LARGE
+    };
+    
+    randomSeed(1);
+    logInit(nullptr);
+    gState = GameState_Game;
+    gShip = createShip();
+    gAsteroids.reserve(nAsteroids);
+    
+    for (int i = 0; i < nAsteroids; i++)
+    {
+        gAsteroids.push_back(createAsteroid(sizes[random(0, 2)]));
+    }
+    
+    Uint64 start = SDL_GetPerformanceCounter();
+    
+    if (!writeScenario(path))
+    {
+        return;
+    }
+    
+    double writeMs = (SDL_GetPerformanceCounter() - start) * 1000.0 /
+                     SDL_GetPerformanceFrequency();
+    
+    gAsteroids.clear();
+    gAsteroids.shrink_to_fit();
+    start = SDL_GetPerformanceCounter();
+    
+    if (!loadScenario(path))
+    {
+        return;
+    }
+    
+    double loadMs = (SDL_GetPerformanceCounter() - start) * 1000.0 /
+                    SDL_GetPerformanceFrequency();
+    
+    std::cout << nAsteroids << " asteroids, "
+              << nAsteroids * sizeof(Asteroid) / (1024 * 1024) << " MB: write "
+              << writeMs << " ms, load " << loadMs << " ms" << std::endl;
+}
+
+static void wrapPosition(Vector2f &position, int bufferX, int bufferY)
+{
+    Vector2f wrapMin = {
+        realFromInt(-WRAPBUFFER_X),
+        realFromInt(-WRAPBUFFER_Y)
+    };
+    
+    Vector2f wrapMax = {
+        realFromInt(WINDOW_WIDTH + WRAPBUFFER_X),
+        realFromInt(WINDOW_HEIGHT + WRAPBUFFER_Y)
+    };
+    
+    if (position.x < wrapMin.x)
+    {
+        position.x = wrapMax.x - realFromInt(1);
+    }
+    
+    if (position.x >= wrapMax.x)
+    {
+        position.x = wrapMin.x;
+    }
+    
+    if (position.y < wrapMin.y)
+    {
+        position.y = wrapMax.y - realFromInt(1);
+    }
+    
+    if (position.y >= wrapMax.y)
+    {
+        position.y = wrapMin.y;
+    }
+}
+
+static void checkCollisions(const Ship &ship,
+                            const std::vector<Asteroid> &asteroids,
+                            TransformCache &transforms)
+{
+    for (int asteroidIndex = 0;
+         asteroidIndex < asteroids.size();
+         asteroidIndex++)
+    {
+        checkCollision(ship, asteroids, asteroidIndex, transforms);
+    }
+}
+
+static void checkCollision(Ship ship,
+                           const std::vector<Asteroid> &asteroids,
+                           int asteroidIndex,
+                           TransformCache &transforms)
+{
+    if (shipAsteroidOverlapSAT(ship, asteroids, asteroidIndex, transforms))
+    {
+        explode(ship.position);
+        gState = GameState_Lost;
+    }
 }
 
-static void fireProjectileFromPoint(Vector2f point, float angle)
+static void fireProjectileFromPoint(Vector2f point, Real angle)
 {
     gProjectiles.push_back(createProjectile(point, angle, PROJECTILE_SPEED));
+    audioPlay(Sound_Fire);
 }
 
 static void destroyProjectile(int projectileIndex, std::vector<Projectile> &projectiles)
@@ -895,6 +3170,10 @@ static void destroyAsteroid(int asteroidIndex)
         gAsteroids[asteroidIndex] = gAsteroids[gAsteroids.size() - 1];
     }
     
+    // The slot left behind at the end would otherwise look current to the
+    // next asteroid pushed into it.
+    dirtyTransform(gAsteroidTransforms, asteroidIndex);
+    dirtyTransform(gAsteroidTransforms, (int)gAsteroids.size() - 1);
     gAsteroids.pop_back();
 }
 
@@ -930,59 +3209,67 @@ static void splitAsteroid(int asteroidIndex)
     
     gAsteroids.push_back(newAsteroid1);
     gAsteroids.push_back(newAsteroid2);
+    audioPlay(Sound_Split);
     
     destroyAsteroid(asteroidIndex);
 }
 
-static void checkProjectileCollisions(std::vector<Projectile> projectiles,
-                                      std::vector<Asteroid> asteroids)
+static void checkProjectileCollisions(const std::vector<Projectile> &projectiles,
+                                      const std::vector<Asteroid> &asteroids,
+                                      TransformCache &transforms)
 {
+    AsteroidEdges edges;
+    
     for (int asteroidIndex = 0;
          asteroidIndex < asteroids.size();
          asteroidIndex++)
     {
-        Asteroid asteroid = asteroids[asteroidIndex];
-        bool breakFlag = false;
+        const Asteroid &asteroid = asteroids[asteroidIndex];
+        Vector2f asteroidPosition = asteroid.position;
+        Real radius = asteroid.size * ASTEROID_RADIUS_MAX;
+        bool haveEdges = false;
         
-        for (int aLineIndex = 0;
-             aLineIndex < N_LINES;
-             aLineIndex++)
+        for (int projectileIndex = 0;
+             projectileIndex < projectiles.size();
+             projectileIndex++)
         {
-            Line asteroidLine = asteroid.shape.lines[aLineIndex];
-            breakFlag = false;
+            const Projectile &projectile = projectiles[projectileIndex];
+            Vector2f previous = {
+                projectile.position.x - projectile.velocity.x,
+                projectile.position.y - projectile.velocity.y
+            };
             
-            for (int projectileIndex = 0;
-                 projectileIndex < projectiles.size();
-                 projectileIndex++)
+            // Most asteroids have no shot anywhere near their bounding box
+            // and never need their outline.
+            if (std::max(projectile.position.x, previous.x) < asteroidPosition.x - radius ||
+                std::min(projectile.position.x, previous.x) > asteroidPosition.x + radius ||
+                std::max(projectile.position.y, previous.y) < asteroidPosition.y - radius ||
+                std::min(projectile.position.y, previous.y) > asteroidPosition.y + radius)
             {
-                Projectile projectile = projectiles[projectileIndex];
-                
-                Vector2f lastPoint = {
-                    projectile.position.x - projectile.velocity.x,
-                    projectile.position.y - projectile.velocity.y
-                };
-                
-                Line collisionLine = { projectile.position, lastPoint };
-                
-                if (linesIntersect({ 0, 0 }, asteroid.position, collisionLine, asteroidLine))
-                {
-                    explode(asteroid.position);
-                    splitAsteroid(asteroidIndex);
-                    destroyProjectile(projectileIndex, gProjectiles);
-                    breakFlag = true;
-                    break;
-                }
+                continue;
             }
             
-            if (breakFlag)
+            if (!haveEdges)
             {
-                break;
+                asteroidEdges(asteroid,
+                              asteroidWorldVertices(transforms, asteroids, asteroidIndex),
+                              edges);
+                haveEdges = true;
+            }
+            
+            // The projectile's path over the last tick against every edge.
+            if (segmentCrossesEdges(projectile.position, previous, edges))
+            {
+                explode(asteroidPosition);
+                splitAsteroid(asteroidIndex);
+                destroyProjectile(projectileIndex, gProjectiles);
+                return;
             }
         }
         
-        if (breakFlag)
+        if (!haveEdges)
         {
-            break;
+            transforms.avoided++;
         }
     }
 }
@@ -990,43 +3277,680 @@ static void checkProjectileCollisions(std::vector<Projectile> projectiles,
 static void explode(Vector2f position)
 {
     int nParticles = 10;
-    float speed = 2.0f;
-    float step = (2 * M_PI) / nParticles;
+    
+    audioPlay(Sound_Explosion);
     
     for (int i = 0; i < nParticles; i++)
     {
-        gParticles.push_back(createProjectile(position, step * i, speed));
+        gParticles.push_back(createProjectile(position, REAL_TWO_PI * i / nParticles, PARTICLE_SPEED));
     }
 }
 
-static TTF_Font *loadFont(const char *path)
+// Expands the baked 1-bit glyph rows into a single white-on-transparent
+// texture so text is drawn with plain SDL_RenderCopy calls and nothing has
+// to be loaded from disk.
+static SDL_Texture *createFontAtlas()
 {
-    SDL_RWops *fontRWops = SDL_RWFromFile(path, "rb");
+    int atlasRows = (FONTATLAS_N_GLYPHS + TEXT_ATLAS_COLUMNS - 1) / TEXT_ATLAS_COLUMNS;
+    int atlasWidth = TEXT_ATLAS_COLUMNS * FONTATLAS_GLYPH_WIDTH;
+    int atlasHeight = atlasRows * FONTATLAS_GLYPH_HEIGHT;
+    
+    SDL_Texture *atlas = SDL_CreateTexture(gRenderer,
+                                           SDL_PIXELFORMAT_ARGB8888,
+                                           SDL_TEXTUREACCESS_STATIC,
+                                           atlasWidth,
+                                           atlasHeight);
     
-    if (fontRWops == nullptr)
+    if (atlas == nullptr)
     {
-        std::cout << "Unable to load font " << path << std::endl;
-        std::cout << TTF_GetError() << std::endl;
+        logMessage(LogLevel_Error, "Unable to create font atlas: %s", SDL_GetError());
         quit();
         exit(1);
     }
     
-    TTF_Font *font = TTF_OpenFontRW(fontRWops, 1, 72);
+    std::vector<Uint32> pixels(atlasWidth * atlasHeight, 0x00FFFFFF);
     
-    if (font == nullptr)
+    for (int glyphIndex = 0; glyphIndex < FONTATLAS_N_GLYPHS; glyphIndex++)
     {
-        std::cout << "Unable to load font " << path << std::endl;
-        std::cout << TTF_GetError() << std::endl;
-        quit();
-        exit(1);
+        int originX = (glyphIndex % TEXT_ATLAS_COLUMNS) * FONTATLAS_GLYPH_WIDTH;
+        int originY = (glyphIndex / TEXT_ATLAS_COLUMNS) * FONTATLAS_GLYPH_HEIGHT;
+        
+        for (int y = 0; y < FONTATLAS_GLYPH_HEIGHT; y++)
+        {
+            unsigned int row = FONTATLAS_ROWS[glyphIndex][y];
+            
+            for (int x = 0; x < FONTATLAS_GLYPH_WIDTH; x++)
+            {
+                if (row & (1u << x))
+                {
+                    pixels[(originY + y) * atlasWidth + originX + x] = 0xFFFFFFFF;
+                }
+            }
+        }
+    }
+    
+    SDL_UpdateTexture(atlas, nullptr, &pixels[0], atlasWidth * sizeof(Uint32));
+    SDL_SetTextureBlendMode(atlas, SDL_BLENDMODE_BLEND);
+    
+    return atlas;
+}
+
+// Rasterizes every outline variant at every rotation, using the same
+// vertices and pixel truncation as renderAsteroid so sprites and lines
+// match at the atlas angles.  Frames are drawn one at a time into a small
+// reused buffer and uploaded to their own rect: filling a whole atlas-sized
+// buffer first would cost more startup time than all the drawing.  Returns
+// nullptr, leaving sprite mode unavailable, if the renderer can't take a
+// texture this large.
+static SDL_Texture *createAsteroidAtlas()
+{
+    const int nFrames = ASTEROID_VARIANTS * ASTEROID_ROTATIONS;
+    int maxFrameSize = 0;
+    gAtlasHeight = 0;
+    
+    for (int sizeIndex = 0; sizeIndex < N_ASTEROID_SIZES; sizeIndex++)
+    {
+        int maxRadius = 0;
+        
+        for (int variant = 0; variant < ASTEROID_VARIANTS; variant++)
+        {
+            const Polygon &shape = gAsteroidShapes[sizeIndex][variant];
+            
+            for (int i = 0; i < shape.nVertices; i++)
+            {
+                maxRadius = std::max(maxRadius, (int)shape.radii[i]);
+            }
+        }
+        
+        SpriteShelf &shelf = gAtlasShelves[sizeIndex];
+        shelf.originY = gAtlasHeight;
+        shelf.frameSize = 2 * maxRadius + 3;
+        shelf.columns = ASTEROID_ATLAS_WIDTH / shelf.frameSize;
+        gAtlasHeight += (nFrames + shelf.columns - 1) / shelf.columns * shelf.frameSize;
+        maxFrameSize = std::max(maxFrameSize, shelf.frameSize);
+    }
+    
+    SDL_RendererInfo info;
+    
+    if (SDL_GetRendererInfo(gRenderer, &info) == 0 && info.max_texture_width > 0 &&
+        (info.max_texture_width < ASTEROID_ATLAS_WIDTH || info.max_texture_height < gAtlasHeight))
+    {
+        logMessage(LogLevel_Warning, "Asteroid atlas is %dx%d but %s allows %dx%d, sprites disabled",
+                   ASTEROID_ATLAS_WIDTH, gAtlasHeight, info.name,
+                   info.max_texture_width, info.max_texture_height);
+        return nullptr;
+    }
+    
+    SDL_Texture *atlas = SDL_CreateTexture(gRenderer,
+                                           SDL_PIXELFORMAT_ARGB8888,
+                                           SDL_TEXTUREACCESS_STATIC,
+                                           ASTEROID_ATLAS_WIDTH,
+                                           gAtlasHeight);
+    
+    if (atlas == nullptr)
+    {
+        logMessage(LogLevel_Warning, "Unable to create asteroid atlas, sprites disabled: %s",
+                   SDL_GetError());
+        return nullptr;
+    }
+    
+    std::vector<Uint32> pixels(maxFrameSize * maxFrameSize);
+    
+    for (int sizeIndex = 0; sizeIndex < N_ASTEROID_SIZES; sizeIndex++)
+    {
+        const SpriteShelf &shelf = gAtlasShelves[sizeIndex];
+        int frameSize = shelf.frameSize;
+        Vector2f center = {
+            realFromInt(frameSize / 2),
+            realFromInt(frameSize / 2)
+        };
+        
+        for (int frame = 0; frame < nFrames; frame++)
+        {
+            Asteroid asteroid;
+            asteroid.shape = gAsteroidShapes[sizeIndex][frame / ASTEROID_ROTATIONS];
+            asteroid.angle = REAL_TWO_PI * (frame % ASTEROID_ROTATIONS) / ASTEROID_ROTATIONS;
+            
+            Vector2f vertices[MAX_POLYGON_VERTICES];
+            int nVertices = asteroidVertices(asteroid, vertices);
+            
+            std::fill(pixels.begin(), pixels.begin() + frameSize * frameSize, 0x00FFFFFF);
+            
+            for (int i = 0; i < nVertices; i++)
+            {
+                Vector2f p1 = vertices[i];
+                Vector2f p2 = vertices[(i + 1) % nVertices];
+                
+                rasterizeLine(&pixels[0], frameSize,
+                              realToInt(p1.x + center.x), realToInt(p1.y + center.y),
+                              realToInt(p2.x + center.x), realToInt(p2.y + center.y));
+            }
+            
+            SDL_Rect rect = {
+                (frame % shelf.columns) * frameSize,
+                shelf.originY + (frame / shelf.columns) * frameSize,
+                frameSize,
+                frameSize
+            };
+            
+            SDL_UpdateTexture(atlas, &rect, &pixels[0], frameSize * sizeof(Uint32));
+        }
+    }
+    
+    SDL_SetTextureBlendMode(atlas, SDL_BLENDMODE_BLEND);
+    
+    logMessage(LogLevel_Debug, "Asteroid atlas %dx%d, %d frames",
+               ASTEROID_ATLAS_WIDTH, gAtlasHeight, N_ASTEROID_SIZES * nFrames);
+    
+    return atlas;
+}
+
+// Bresenham, inclusive of both ends, in opaque white.
+static void rasterizeLine(Uint32 *pixels, int pitch, int x1, int y1, int x2, int y2)
+{
+    int dx = abs(x2 - x1);
+    int dy = -abs(y2 - y1);
+    int stepX = (x1 < x2) ? 1 : -1;
+    int stepY = (y1 < y2) ? 1 : -1;
+    int error = dx + dy;
+    
+    while (true)
+    {
+        pixels[y1 * pitch + x1] = 0xFFFFFFFF;
+        
+        if (x1 == x2 && y1 == y2)
+        {
+            break;
+        }
+        
+        int error2 = 2 * error;
+        
+        if (error2 >= dy)
+        {
+            error += dy;
+            x1 += stepX;
+        }
+        
+        if (error2 <= dx)
+        {
+            error += dx;
+            y1 += stepY;
+        }
+    }
+}
+
+// Times the SAT ship test against the edge-crossing baseline over a field
+// of random asteroids placed around random ship poses.
+static void runCollisionBenchmark()
+{
+    const int nPairs = 100000;
+    const int nRepeats = 20;
+    
+    randomSeed(1);
+    
+    std::vector<Ship> ships;
+    std::vector<Asteroid> asteroids;
+    
+    for (int i = 0; i < nPairs; i++)
+    {
+        Ship ship = createShip();
+        ship.angle = randomNormal() * REAL_TWO_PI;
+        orientShip(ship);
+        
+        AsteroidSize sizes[] = {
+            ASTEROIDSIZE_SMALL, ASTEROIDSIZE_MEDIUM, ASTEROIDSIZE_LARGE
+        };
+        Asteroid asteroid = createAsteroid(sizes[random(0, 2)]);
+        asteroid.angle = randomNormal() * REAL_TWO_PI;
+        asteroid.position = {
+            ship.position.x + realFromInt(random(-80, 80)),
+            ship.position.y + realFromInt(random(-80, 80))
+        };
+        
+        ships.push_back(ship);
+        asteroids.push_back(asteroid);
+    }
+    
+    std::cout << "Asteroid size: " << sizeof(Asteroid) << " bytes" << std::endl;
+    
+    const char *names[] = { "segments", "SAT" };
+    int hits[2] = { 0, 0 };
+    TransformCache transforms;
+    transforms.entries.reserve(nPairs);
+    
+    for (int method = 0; method < 2; method++)
+    {
+        Uint64 start = SDL_GetPerformanceCounter();
+        
+        for (int repeat = 0; repeat < nRepeats; repeat++)
+        {
+            hits[method] = 0;
+            // Each repeat pays for its transforms, as each game tick does.
+            invalidateTransforms(transforms);
+            
+            for (int i = 0; i < nPairs; i++)
+            {
+                bool hit = (method == 0) ?
+                    shipAsteroidOverlapSegments(ships[i], asteroids[i]) :
+                    shipAsteroidOverlapSAT(ships[i], asteroids, i, transforms);
+                hits[method] += hit;
+            }
+        }
+        
+        double ns = (SDL_GetPerformanceCounter() - start) * 1e9 /
+                    SDL_GetPerformanceFrequency() / ((double)nPairs * nRepeats);
+        std::cout << names[method] << ": " << ns << " ns/test, "
+                  << hits[method] << " hits" << std::endl;
+    }
+}
+
+// Drives the mixer without a window, two seconds of game-like traffic with
+// a held thrust loop, then prints callback cost and underruns.  Defaults to
+// SDL's dummy driver; set SDL_AUDIODRIVER=disk to also capture the output.
+static void runAudioBenchmark()
+{
+    SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+    
+    if (SDL_Init(SDL_INIT_AUDIO | SDL_INIT_TIMER) < 0 || !audioInit())
+    {
+        std::cout << "Unable to open audio: " << SDL_GetError() << std::endl;
+        SDL_Quit();
+        return;
+    }
+    
+    audioSetLoop(Sound_Thrust, true);
+    
+    for (int tick = 0; tick < 120; tick++)
+    {
+        audioPlay(Sound_Fire);
+        
+        if (tick % 10 == 0)
+        {
+            audioPlay(Sound_Explosion);
+            audioPlay(Sound_Split);
+        }
+        
+        SDL_Delay(MS_PER_UPDATE);
+    }
+    
+    audioSetLoop(Sound_Thrust, false);
+    SDL_Delay(100);
+    
+    AudioStats stats;
+    audioGetStats(stats);
+    
+    std::cout << "Driver: " << SDL_GetCurrentAudioDriver() << std::endl;
+    std::cout << "Callbacks: " << stats.callbacks
+              << " (" << stats.bufferMs << " ms buffer)" << std::endl;
+    std::cout << "Callback time: " << stats.averageCallbackUs << " us avg, "
+              << stats.maxCallbackUs << " us max" << std::endl;
+    std::cout << "Underruns: " << stats.underruns
+              << ", dropped commands: " << stats.droppedCommands
+              << ", stolen voices: " << stats.stolenVoices << std::endl;
+    
+    audioQuit();
+    SDL_Quit();
+}
+
+// Times one swept segment against a full 16-edge asteroid: the per-pair
+// linesIntersect loop, then the scalar and widest SIMD batch kernels in
+// float and in integer grid coordinates.  The float kernels must agree
+// with linesIntersect and the integer ones with each other; the grid
+// rounds coordinates to 1/64 pixel, so a few grazing hits can differ
+// between the two.
+static void runSegmentBenchmark()
+{
+    // Small enough to stay cache resident, so this measures the kernels.
+    const int nCases = 1024;
+    const int nRepeats = 2000;
+    
+    randomSeed(1);
+    
+    std::vector<Asteroid> asteroids(nCases);
+    std::vector<Vector2f> vertices(nCases * MAX_POLYGON_VERTICES);
+    // Static so the batches get their declared alignment, which std::vector
+    // doesn't promise before C++17.
+    static SegmentBatch batches[nCases];
+    static SegmentBatchInt intBatches[nCases];
+    std::vector<Line> segments(nCases);
+    std::vector<Sint32> intSegments(nCases * 4); // Relative to the asteroid.
+    TransformCache transforms;
+    
+    for (int i = 0; i < nCases; i++)
+    {
+        asteroids[i] = createAsteroid(ASTEROIDSIZE_LARGE);
+        asteroids[i].shape.nVertices = MAX_POLYGON_VERTICES;
+        asteroids[i].angle = randomNormal() * REAL_TWO_PI;
+        asteroidVertices(asteroids[i], &vertices[i * MAX_POLYGON_VERTICES]);
+        
+        const Vector2f *world = asteroidWorldVertices(transforms, asteroids, i);
+        asteroidEdgeBatch(world, MAX_POLYGON_VERTICES, batches[i]);
+        asteroidEdgeBatchInt(world, MAX_POLYGON_VERTICES, asteroids[i].position, intBatches[i]);
+        
+        Vector2f start = {
+            asteroids[i].position.x + realFromInt(random(-70, 70)),
+            asteroids[i].position.y + realFromInt(random(-70, 70))
+        };
+        Real angle = randomNormal() * REAL_TWO_PI;
+        
+        segments[i] = {
+            start,
+            {
+                start.x - realCos(angle) * PROJECTILE_SPEED,
+                start.y - realSin(angle) * PROJECTILE_SPEED
+            }
+        };
+        
+        Sint32 originX = edgeGridCoordinate(asteroids[i].position.x);
+        Sint32 originY = edgeGridCoordinate(asteroids[i].position.y);
+        intSegments[i * 4 + 0] = edgeGridCoordinate(segments[i].p1.x) - originX;
+        intSegments[i * 4 + 1] = edgeGridCoordinate(segments[i].p1.y) - originY;
+        intSegments[i * 4 + 2] = edgeGridCoordinate(segments[i].p2.x) - originX;
+        intSegments[i * 4 + 3] = edgeGridCoordinate(segments[i].p2.y) - originY;
+    }
+    
+    const int nMethods = 5;
+    const char *names[nMethods] = {
+        "linesIntersect", "batch scalar", segmentBatchKernelName(),
+        "batch int scalar", segmentBatchIntKernelName()
+    };
+    std::vector<Uint32> masks[nMethods];
+    
+    for (int method = 0; method < nMethods; method++)
+    {
+        masks[method].resize(nCases);
+        Uint64 start = SDL_GetPerformanceCounter();
+        
+        for (int repeat = 0; repeat < nRepeats; repeat++)
+        {
+            for (int i = 0; i < nCases; i++)
+            {
+                const Line &segment = segments[i];
+                const Sint32 *intSegment = &intSegments[i * 4];
+                float x1 = realToFloat(segment.p1.x), y1 = realToFloat(segment.p1.y);
+                float x2 = realToFloat(segment.p2.x), y2 = realToFloat(segment.p2.y);
+                Uint32 mask = 0;
+                
+                if (method == 0)
+                {
+                    const Vector2f *asteroidVertices = &vertices[i * MAX_POLYGON_VERTICES];
+                    Vector2f zero = { realFromInt(0), realFromInt(0) };
+                    
+                    for (int edge = 0; edge < MAX_POLYGON_VERTICES; edge++)
+                    {
+                        Line asteroidLine = {
+                            asteroidVertices[edge],
+                            asteroidVertices[(edge + 1) % MAX_POLYGON_VERTICES]
+                        };
+                        
+                        mask |= (Uint32)linesIntersect(zero, asteroids[i].position,
+                                                       segment, asteroidLine) << edge;
+                    }
+                }
+                else if (method == 1)
+                {
+                    mask = segmentBatchIntersectScalar(x1, y1, x2, y2, batches[i]);
+                }
+                else if (method == 2)
+                {
+                    mask = segmentBatchIntersect(x1, y1, x2, y2, batches[i]);
+                }
+                else if (method == 3)
+                {
+                    mask = segmentBatchIntersectIntScalar(intSegment[0], intSegment[1],
+                                                          intSegment[2], intSegment[3],
+                                                          intBatches[i]);
+                }
+                else
+                {
+                    mask = segmentBatchIntersectInt(intSegment[0], intSegment[1],
+                                                    intSegment[2], intSegment[3],
+                                                    intBatches[i]);
+                }
+                
+                masks[method][i] = mask;
+            }
+        }
+        
+        double ns = (SDL_GetPerformanceCounter() - start) * 1e9 /
+                    SDL_GetPerformanceFrequency() / ((double)nCases * nRepeats);
+        std::cout << names[method] << ": " << ns << " ns per segment vs "
+                  << MAX_POLYGON_VERTICES << " edges" << std::endl;
+    }
+    
+    int mismatches = 0;
+    int gridDifferences = 0;
+    int hits = 0;
+    
+    for (int i = 0; i < nCases; i++)
+    {
+        mismatches += (masks[0][i] != masks[1][i]) || (masks[0][i] != masks[2][i]) ||
+                      (masks[3][i] != masks[4][i]);
+        gridDifferences += (masks[1][i] != masks[3][i]);
+        hits += (masks[0][i] != 0);
+    }
+    
+    std::cout << hits << " of " << nCases << " segments hit, "
+              << mismatches << " mismatches, "
+              << gridDifferences << " differ on the integer grid" << std::endl;
+}
+
+// Draws random fields with lines and then with sprites, to a hidden window
+// with vsync off, and times whole frames including present.
+static void runSpriteBenchmark()
+{
+    const int counts[] = { 1000, 10000, 50000 };
+    const int nCounts = sizeof(counts) / sizeof(counts[0]);
+    const int nFrames = 60;
+    const char *names[2] = { "lines", "sprites" };
+    AsteroidSize sizes[] = {
+        ASTEROIDSIZE_SMALL, ASTEROIDSIZE_MEDIUM, ASTEROIDSIZE_LARGE
+    };
+    
+    randomSeed(1);
+    logInit(nullptr);
+    
+    if (SDL_Init(SDL_INIT_VIDEO) < 0)
+    {
+        logMessage(LogLevel_Error, "Unable to init SDL: %s", SDL_GetError());
+        return;
+    }
+    
+    gWindow = SDL_CreateWindow(TITLE, WINDOW_POSX, WINDOW_POSY,
+                               WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_HIDDEN);
+    gRenderer = (gWindow != nullptr) ?
+        SDL_CreateRenderer(gWindow, -1, SDL_RENDERER_ACCELERATED) : nullptr;
+    gAsteroidAtlas = (gRenderer != nullptr) ? createAsteroidAtlas() : nullptr;
+    
+    if (gAsteroidAtlas == nullptr)
+    {
+        logMessage(LogLevel_Error, "Unable to set up rendering: %s", SDL_GetError());
+        SDL_Quit();
+        return;
+    }
+    
+    gAsteroids.reserve(counts[nCounts - 1]);
+    gAsteroidTransforms.entries.reserve(counts[nCounts - 1]);
+    sizeSpriteBuffers(counts[nCounts - 1]);
+    
+    for (int countIndex = 0; countIndex < nCounts; countIndex++)
+    {
+        gAsteroids.clear();
+        
+        for (int i = 0; i < counts[countIndex]; i++)
+        {
+            Asteroid asteroid = createAsteroid(sizes[random(0, 2)]);
+            asteroid.angle = randomNormal() * REAL_TWO_PI;
+            gAsteroids.push_back(asteroid);
+        }
+        
+        for (int method = 0; method < 2; method++)
+        {
+            Uint64 start = SDL_GetPerformanceCounter();
+            
+            for (int frame = 0; frame < nFrames; frame++)
+            {
+                gDrawCalls = 0;
+                SDL_SetRenderDrawColor(gRenderer, 0, 0, 0, 255);
+                SDL_RenderClear(gRenderer);
+                
+                if (method == 0)
+                {
+                    // In the game every frame follows a tick that moved
+                    // every asteroid, so none of the outlines carry over.
+                    invalidateTransforms(gAsteroidTransforms);
+                    renderAsteroids(gAsteroids, gAsteroidTransforms);
+                }
+                else
+                {
+                    renderAsteroidSprites(gAsteroids);
+                }
+                
+                SDL_RenderPresent(gRenderer);
+            }
+            
+            double ms = (SDL_GetPerformanceCounter() - start) * 1000.0 /
+                        SDL_GetPerformanceFrequency() / nFrames;
+            std::cout << counts[countIndex] << " asteroids, " << names[method] << ": "
+                      << ms << " ms per frame, " << gDrawCalls << " draw calls" << std::endl;
+        }
+    }
+    
+    SDL_DestroyTexture(gAsteroidAtlas);
+    SDL_DestroyRenderer(gRenderer);
+    SDL_DestroyWindow(gWindow);
+    SDL_Quit();
+}
+
+// FNV-1a over the bits of every simulated value.  In the fixed-point build
+// two runs from the same seed and input agree tick for tick on any
+// compiler and CPU, so comparing these is enough to spot a desync.
+static Uint64 hashState()
+{
+    Uint64 hash = 14695981039346656037ull;
+    
+    hashValue(hash, gTicks);
+    hashValue(hash, gState);
+    hashValue(hash, (Uint32)gAsteroids.size());
+    
+    for (int i = 0; i < (int)gAsteroids.size(); i++)
+    {
+        const Asteroid &asteroid = gAsteroids[i];
+        
+        hashValue(hash, asteroid.size);
+        hashVector(hash, asteroid.position);
+        hashVector(hash, asteroid.velocity);
+        hashValue(hash, realBits(asteroid.angle));
+        hashValue(hash, realBits(asteroid.angularVelocity));
+        hashValue(hash, asteroid.variant);
+        hashValue(hash, asteroid.shape.nVertices);
+        
+        for (int vertex = 0; vertex < asteroid.shape.nVertices; vertex++)
+        {
+            hashValue(hash, asteroid.shape.radii[vertex]);
+        }
+    }
+    
+    hashVector(hash, gShip.position);
+    hashVector(hash, gShip.velocity);
+    hashValue(hash, realBits(gShip.speed));
+    hashValue(hash, realBits(gShip.angle));
+    hashValue(hash, gShip.cooldown);
+    
+    for (int i = 0; i < N_SHIP_LINES; i++)
+    {
+        hashVector(hash, gShip.lines[i].p1);
+        hashVector(hash, gShip.lines[i].p2);
+    }
+    
+    const std::vector<Projectile> *lists[] = { &gProjectiles, &gParticles };
+    
+    for (int list = 0; list < 2; list++)
+    {
+        hashValue(hash, (Uint32)lists[list]->size());
+        
+        for (int i = 0; i < (int)lists[list]->size(); i++)
+        {
+            const Projectile &projectile = (*lists[list])[i];
+            
+            hashVector(hash, projectile.position);
+            hashVector(hash, projectile.velocity);
+            hashValue(hash, projectile.lifeCounter);
+        }
+    }
+    
+    return hash;
+}
+
+static void hashValue(Uint64 &hash, Uint32 value)
+{
+    for (int byte = 0; byte < 4; byte++)
+    {
+        hash ^= (value >> (byte * 8)) & 0xFF;
+        hash *= 1099511628211ull;
+    }
+}
+
+static void hashVector(Uint64 &hash, Vector2f vector)
+{
+    hashValue(hash, realBits(vector.x));
+    hashValue(hash, realBits(vector.y));
+}
+
+// Plays nTicks of a scripted game without a window, from seed and with
+// nAsteroids to start, and prints the state hash along the way.  Runs of
+// the fixed-point build print the same hashes whatever built them.
+static void runHashRun(int nTicks, Uint32 seed, int nAsteroids)
+{
+    const int hashInterval = 600;
+    
+    randomSeed(seed);
+    logInit(nullptr);
+    reserveAsteroids(std::max(nAsteroids * asteroidPieces(ASTEROIDSIZE_LARGE),
+                              ASTEROID_CAPACITY));
+    gProjectiles.reserve(PROJECTILE_CAPACITY);
+    gParticles.reserve(PARTICLE_CAPACITY);
+    init();
+    
+    for (int i = N_INIT_ASTEROIDS; i < nAsteroids; i++)
+    {
+        gAsteroids.push_back(createAsteroid(ASTEROIDSIZE_LARGE));
+    }
+    
+    std::cout << (ASTEROIDS_FIXED_POINT ? "fixed" : "float") << " build, seed " << seed
+              << ", " << gAsteroids.size() << " asteroids" << std::endl;
+    
+    Uint64 start = SDL_GetPerformanceCounter();
+    
+    for (int tick = 0; tick < nTicks; tick++)
+    {
+        // Input depends only on the tick: sweeps of turning and thrust,
+        // bursts of fire, and a restart whenever a round ends.
+        setInput(InputAction_TurnLeft, (tick / 45) % 4 == 1);
+        setInput(InputAction_TurnRight, (tick / 45) % 4 == 3);
+        setInput(InputAction_Thrust, (tick / 90) % 3 == 0);
+        setInput(InputAction_Shoot, (tick / 20) % 2 == 0);
+        setInput(InputAction_Restart, gState != GameState_Game);
+        update();
+        
+        if ((tick + 1) % hashInterval == 0 || tick + 1 == nTicks)
+        {
+            char hash[17];
+            snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)hashState());
+            std::cout << "tick " << gTicks << ": " << hash << ", "
+                      << gAsteroids.size() << " asteroids" << std::endl;
+        }
     }
     
-    return font;
+    double ms = (SDL_GetPerformanceCounter() - start) * 1000.0 /
+                SDL_GetPerformanceFrequency();
+    std::cout << ms / std::max(nTicks, 1) << " ms/tick" << std::endl;
 }
 
 static void checkWin()
 {
-    std::cout << "Asteroids: " << gAsteroids.size() << std::endl;
+    static LogRateLimit asteroidCountLimit = LOG_RATE_LIMIT(1000);
+    logLimited(asteroidCountLimit, LogLevel_Debug, "Asteroids: %d", (int)gAsteroids.size());
     
     if (gAsteroids.size() == 0)
     {
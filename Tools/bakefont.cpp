@@ -0,0 +1,131 @@
+//
+//  bakefont.cpp
+//  Asteroids1
+//
+//  Renders printable ASCII from a TTF and writes Asteroids1/FontAtlas.h to
+//  stdout, so the game never has to open a font file at startup.
+//
+//  Usage: bakefont <font.ttf> <pointSize> > Asteroids1/FontAtlas.h
+//
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <vector>
+#include <SDL2/SDL.h>
+#include <SDL2_ttf/SDL_ttf.h>
+
+static const int FIRST_CHAR = 32;
+static const int LAST_CHAR = 126;
+static const int MAX_GLYPH_WIDTH = 32; // One unsigned int per row.
+
+int main(int argc, const char * argv[])
+{
+    if (argc != 3)
+    {
+        fprintf(stderr, "Usage: %s <font.ttf> <pointSize>\n", argv[0]);
+        return 1;
+    }
+
+    if (SDL_Init(0) < 0 || TTF_Init() == -1)
+    {
+        fprintf(stderr, "Unable to init SDL_ttf\n");
+        return 1;
+    }
+
+    TTF_Font *font = TTF_OpenFont(argv[1], atoi(argv[2]));
+
+    if (font == nullptr)
+    {
+        fprintf(stderr, "Unable to load font %s\n%s\n", argv[1], TTF_GetError());
+        return 1;
+    }
+
+    int nGlyphs = LAST_CHAR - FIRST_CHAR + 1;
+    int glyphWidth = 0;
+    int glyphHeight = TTF_FontHeight(font);
+
+    for (int c = FIRST_CHAR; c <= LAST_CHAR; c++)
+    {
+        int advance = 0;
+        TTF_GlyphMetrics(font, c, nullptr, nullptr, nullptr, nullptr, &advance);
+
+        if (advance > glyphWidth)
+        {
+            glyphWidth = advance;
+        }
+    }
+
+    if (glyphWidth > MAX_GLYPH_WIDTH)
+    {
+        fprintf(stderr, "Glyphs are %d px wide; use a smaller point size (max %d px)\n",
+                glyphWidth, MAX_GLYPH_WIDTH);
+        return 1;
+    }
+
+    std::vector<unsigned int> rows(nGlyphs * glyphHeight, 0);
+    SDL_Color white = { 255, 255, 255, 255 };
+
+    for (int c = FIRST_CHAR; c <= LAST_CHAR; c++)
+    {
+        SDL_Surface *surface = TTF_RenderGlyph_Solid(font, c, white);
+
+        if (surface == nullptr)
+        {
+            continue;
+        }
+
+        // Solid rendering gives an 8-bit palettized surface; index 0 is the
+        // background.
+        SDL_LockSurface(surface);
+
+        for (int y = 0; y < surface->h && y < glyphHeight; y++)
+        {
+            const Uint8 *pixels = (const Uint8 *)surface->pixels + y * surface->pitch;
+
+            for (int x = 0; x < surface->w && x < glyphWidth; x++)
+            {
+                if (pixels[x] != 0)
+                {
+                    rows[(c - FIRST_CHAR) * glyphHeight + y] |= 1u << x;
+                }
+            }
+        }
+
+        SDL_UnlockSurface(surface);
+        SDL_FreeSurface(surface);
+    }
+
+    printf("//\n");
+    printf("//  FontAtlas.h\n");
+    printf("//  Asteroids1\n");
+    printf("//\n");
+    printf("//  Generated by Tools/bakefont.cpp from %s at %spt.  Do not edit.\n", argv[1], argv[2]);
+    printf("//\n\n");
+    printf("#ifndef FontAtlas_h\n#define FontAtlas_h\n\n");
+    printf("static const int FONTATLAS_FIRST_CHAR = %d;\n", FIRST_CHAR);
+    printf("static const int FONTATLAS_N_GLYPHS = %d;\n", nGlyphs);
+    printf("static const int FONTATLAS_GLYPH_WIDTH = %d;\n", glyphWidth);
+    printf("static const int FONTATLAS_GLYPH_HEIGHT = %d;\n\n", glyphHeight);
+    printf("static const unsigned int FONTATLAS_ROWS[FONTATLAS_N_GLYPHS][FONTATLAS_GLYPH_HEIGHT] = {\n");
+
+    for (int glyphIndex = 0; glyphIndex < nGlyphs; glyphIndex++)
+    {
+        printf("    {");
+
+        for (int y = 0; y < glyphHeight; y++)
+        {
+            printf("%s0x%02x", (y == 0) ? " " : ", ", rows[glyphIndex * glyphHeight + y]);
+        }
+
+        int c = FIRST_CHAR + glyphIndex;
+        printf(" }, // '%s%c'\n", (c == '\\') ? "\\" : "", c);
+    }
+
+    printf("};\n\n#endif /* FontAtlas_h */\n");
+
+    TTF_CloseFont(font);
+    TTF_Quit();
+    SDL_Quit();
+
+    return 0;
+}
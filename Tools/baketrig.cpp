@@ -0,0 +1,46 @@
+//
+//  baketrig.cpp
+//  Asteroids1
+//
+//  Writes Asteroids1/TrigTable.h, the quarter-wave sine table behind the
+//  fixed-point build's realSin()/realCos().  The table is baked rather than
+//  computed at startup so every machine uses exactly the same values,
+//  whatever its libm does in the last bit.
+//
+//  Usage: baketrig > Asteroids1/TrigTable.h
+//
+
+#include <math.h>
+#include <stdio.h>
+
+static const int QUARTER_STEPS = 1024;
+static const int ONE_BITS = 30;
+
+int main(int argc, const char * argv[])
+{
+    printf("//\n");
+    printf("//  TrigTable.h\n");
+    printf("//  Asteroids1\n");
+    printf("//\n");
+    printf("//  Generated by Tools/baketrig.cpp.  Do not edit.\n");
+    printf("//\n");
+    printf("//  sin(i * pi / 2 / TRIGTABLE_QUARTER_STEPS) with 1.0 = 1 << TRIGTABLE_ONE_BITS.\n");
+    printf("//\n\n");
+    printf("#ifndef TrigTable_h\n#define TrigTable_h\n\n");
+    printf("static const int TRIGTABLE_QUARTER_STEPS = %d;\n", QUARTER_STEPS);
+    printf("static const int TRIGTABLE_ONE_BITS = %d;\n\n", ONE_BITS);
+    printf("static const int TRIGTABLE_SINE[TRIGTABLE_QUARTER_STEPS + 1] = {\n");
+
+    for (int i = 0; i <= QUARTER_STEPS; i++)
+    {
+        long double angle = i * (M_PI / 2) / QUARTER_STEPS;
+        long value = lroundl(sinl(angle) * (1L << ONE_BITS));
+
+        printf("%s%ld,%s", (i % 8 == 0) ? "    " : " ", value,
+               (i % 8 == 7 || i == QUARTER_STEPS) ? "\n" : "");
+    }
+
+    printf("};\n\n#endif /* TrigTable_h */\n");
+
+    return 0;
+}
@@ -0,0 +1,199 @@
+//
+//  telemetry-reader.cpp
+//  Asteroids1
+//
+//  Tails the telemetry region published by `Asteroids1 --telemetry`,
+//  printing one line per tick (or, with --latest, the newest sample ten
+//  times a second).  Waits for the game to start and exits when it quits.
+//  --remove deletes a region left behind by a game that crashed, which
+//  would otherwise keep the next run from creating it.
+//
+//  Usage: telemetry-reader [--latest | --remove] [/name]
+//  Build: c++ -std=c++11 -I Asteroids1 Tools/telemetry-reader.cpp -o telemetry-reader
+//         (add -lrt on glibc older than 2.34)
+//
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Telemetry.h"
+
+static const char *STATE_NAMES[] = { "game", "lost", "won" };
+static const int POLL_US = 10 * 1000;
+static const int LATEST_POLL_US = 100 * 1000;
+
+static void printSample(const TelemetrySample &sample)
+{
+    const char *state = (sample.state >= 0 && sample.state < 3) ? STATE_NAMES[sample.state] : "?";
+
+    printf("%8llu  tick %6.3f ms  frame %6.2f ms  ast %5u  proj %4u  part %5u  %-4s  "
+           "ship %7.1f %7.1f  %6.2f rad  %4.2f px/tick\n",
+           (unsigned long long)sample.tick, sample.tickMs, sample.frameMs,
+           sample.asteroids, sample.projectiles, sample.particles, state,
+           sample.shipX, sample.shipY, sample.shipAngle, sample.shipSpeed);
+}
+
+static const TelemetryRegion *attach(const char *name)
+{
+    bool waiting = false;
+
+    for (;;)
+    {
+        int fd = shm_open(name, O_RDONLY, 0);
+
+        if (fd >= 0)
+        {
+            struct stat info;
+
+            if (fstat(fd, &info) == 0 && info.st_size >= (off_t)sizeof(TelemetryRegion))
+            {
+                void *memory = mmap(nullptr, sizeof(TelemetryRegion), PROT_READ, MAP_SHARED, fd, 0);
+                close(fd);
+
+                if (memory == MAP_FAILED)
+                {
+                    perror("mmap");
+                    return nullptr;
+                }
+
+                const TelemetryRegion *region = (const TelemetryRegion *)memory;
+
+                if (region->magic == TELEMETRY_MAGIC)
+                {
+                    std::atomic_thread_fence(std::memory_order_acquire);
+
+                    if (region->version != TELEMETRY_VERSION ||
+                        region->sampleSize != sizeof(TelemetrySample) ||
+                        region->ringSize != TELEMETRY_RING_SIZE)
+                    {
+                        fprintf(stderr, "%s: version %u, expected %u\n",
+                                name, region->version, TELEMETRY_VERSION);
+                        return nullptr;
+                    }
+
+                    return region;
+                }
+
+                munmap(memory, sizeof(TelemetryRegion));
+            }
+            else
+            {
+                close(fd);
+            }
+        }
+
+        if (!waiting)
+        {
+            fprintf(stderr, "Waiting for %s...\n", name);
+            waiting = true;
+        }
+
+        usleep(LATEST_POLL_US);
+    }
+}
+
+int main(int argc, const char * argv[])
+{
+    const char *name = TELEMETRY_DEFAULT_NAME;
+    bool latest = false;
+    bool remove = false;
+
+    for (int argIndex = 1; argIndex < argc; argIndex++)
+    {
+        if (strcmp(argv[argIndex], "--latest") == 0)
+        {
+            latest = true;
+        }
+        else if (strcmp(argv[argIndex], "--remove") == 0)
+        {
+            remove = true;
+        }
+        else if (argv[argIndex][0] == '/')
+        {
+            name = argv[argIndex];
+        }
+        else
+        {
+            fprintf(stderr, "Usage: %s [--latest | --remove] [/name]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (remove)
+    {
+        if (shm_unlink(name) != 0)
+        {
+            perror(name);
+            return 1;
+        }
+
+        return 0;
+    }
+
+    const TelemetryRegion *region = attach(name);
+
+    if (region == nullptr)
+    {
+        return 1;
+    }
+
+    // Start from the current tick, like tail -f.
+    uint64_t next = region->written.load(std::memory_order_acquire);
+    uint64_t skipped = 0;
+
+    while (region->running.load(std::memory_order_acquire))
+    {
+        TelemetrySample sample;
+
+        if (latest)
+        {
+            if (telemetryReadSlot(region->latest, &sample))
+            {
+                printSample(sample);
+                fflush(stdout);
+            }
+
+            usleep(LATEST_POLL_US);
+            continue;
+        }
+
+        uint64_t written = region->written.load(std::memory_order_acquire);
+
+        if (written - next > (uint64_t)TELEMETRY_RING_SIZE)
+        {
+            skipped += written - next - TELEMETRY_RING_SIZE;
+            next = written - TELEMETRY_RING_SIZE;
+        }
+
+        for (; next < written; next++)
+        {
+            const TelemetrySlot &slot = region->ring[next % TELEMETRY_RING_SIZE];
+
+            // A torn read, or a slot already reused by a later sample, means
+            // the writer lapped us while we were printing.
+            if (!telemetryReadSlot(slot, &sample) ||
+                region->written.load(std::memory_order_acquire) > next + TELEMETRY_RING_SIZE)
+            {
+                skipped++;
+                continue;
+            }
+
+            printSample(sample);
+        }
+
+        fflush(stdout);
+        usleep(POLL_US);
+    }
+
+    if (skipped > 0)
+    {
+        fprintf(stderr, "Skipped %llu samples\n", (unsigned long long)skipped);
+    }
+
+    munmap((void *)region, sizeof(TelemetryRegion));
+
+    return 0;
+}